@@ -1,8 +1,10 @@
 #ifndef AUTOMATA_H
 #define AUTOMATA_H
 #include "defs.h"
+#include <cstdint>
 #include <map>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <string>
 using std::pair;
@@ -23,6 +25,34 @@ struct NFA {
     map<int, int> finality; // multiple final states can be binded differently
 };
 
+// NFA graph in compressed sparse rows, for fast subset construction
+// states are renumbered densely in ascending order of original states
+struct NFAcsr {
+    vector<int> stateId; // {index, original state}
+    vector<int> offsets; // {index, first edge}, numStates + 1 in total
+    vector<int> symbols; // {edge, symbol}
+    vector<int> targets; // {edge, index of next state}
+};
+
+// DFA compiled into flat arrays, for fast execution
+// states are renumbered densely (start state = 0), symbols are bytes
+// bytes with same transitions in all states share one class (column)
+struct DFAtable {
+    int             numStates  = 0;
+    int             numClasses = 0;
+    vector<uint8_t> classMap; // {byte, class}
+    vector<int32_t> trans;    // {state * numClasses + class, next}, -1 for no edge
+    vector<int32_t> finality; // {state, finality}
+};
+
+// self-loop of a DFAtable state, as at most 4 byte ranges [lo, hi]
+// bytes in the ranges keep the state unchanged, so they can be skipped at once
+struct DFAaccel {
+    int     numRanges = 0; // 0 for not acceleratable
+    uint8_t lo[4];
+    uint8_t hi[4];
+};
+
 struct Edge {
     int symbol;
     int from;
@@ -44,13 +74,19 @@ namespace krill::automata {
 using namespace krill::type;
 
 DFA getMinimizedDfa(DFA dfa);
-DFA getDFAfromNFA(NFA nfa);
+// maxStates > 0: throw state_budget_error if DFA goes beyond it
+DFA getDFAfromNFA(const NFA &nfa, int maxStates = 0);
 DFA getDFAintegrated(vector<DFA> dfas);
+NFA getNFAintegrated(const vector<DFA> &dfas);
+DFAtable getDFAtable(const DFA &dfa);
+vector<uint8_t> getByteClasses(const DFA &dfa);
+vector<DFAaccel> getDFAaccels(const DFAtable &table);
 
 // you don't use these
 // -------------------
 
 NFAgraph  toNFAgraph(EdgeTable edgeTable);
+NFAcsr    toNFAcsr(const NFAgraph &nfaGraph);
 DFAgraph  toDFAgraph(EdgeTable edgeTable);
 EdgeTable toEdgeTable(DFAgraph dfa);
 
@@ -60,12 +96,66 @@ DFA getMergedDfa(DFA dfa);
 using Closure    = set<int>;
 using ClosureMap = map<int, Closure>; // {symbol, closure}
 
-void                       setClosureExpanded(Closure &closure, NFAgraph nfa);
-ClosureMap                 getNextClosures(Closure closure, NFAgraph nfa);
-pair<DFAgraph, ClosureMap> getClosureMapfromNFAgraph(NFAgraph nfaGraph);
-map<int, int>              getFinalityFromClosureMap(map<int, int>     nfaFinality,
-                                                     map<int, Closure> closureMap);
+void                       setClosureExpanded(Closure &closure, const NFAgraph &nfa);
+ClosureMap                 getNextClosures(const Closure &closure, const NFAgraph &nfa);
+pair<DFAgraph, ClosureMap> getClosureMapfromNFAgraph(const NFAgraph &nfaGraph,
+                                                     int maxStates = 0);
+map<int, int>              getFinalityFromClosureMap(const map<int, int> &nfaFinality,
+                                                     const ClosureMap    &closureMap);
 DFA                        _getDFAintegrated(vector<DFA> dfas);
+
+struct ClosureHash {
+    size_t operator()(const vector<int> &closure) const {
+        size_t h = closure.size();
+        for (int state : closure) { h = h * 1000003u ^ state; }
+        return h;
+    }
+};
+
+// DFA determinized from NFA on demand (lazy DFA), states are built only
+// when input reaches them, and cached in a bounded table flushed when full;
+// if flushed too often, it stops caching (but for moves of the start state)
+// and simulates the NFA instead
+class LazyDFA {
+  public:
+    LazyDFA() = default;
+    LazyDFA(const NFA &nfa, int maxStates = 4096);
+
+    // start state is always 0, next state -1 if cannot continue
+    int step(int state, unsigned char c) {
+        numSteps_++;
+        int next = (isFallback_ && state != 0) ? -2 : trans_[state * 256 + c];
+        return next != -2 ? next : build(state, c);
+    }
+    int finality(int state) const { return finality_[state]; }
+
+    int  numStates() const { return closures_.size(); }
+    int  numFlushes() const { return numFlushes_; }
+    bool isFallback() const { return isFallback_; }
+
+  private:
+    NFAcsr      nfa_;
+    vector<int> nfaFinality_; // {index, finality}
+    int         maxStates_;
+
+    // cached states, {state, closure} and {state * 256 + byte, next},
+    // -2 for not built yet
+    vector<vector<int>>                               closures_;
+    vector<int32_t>                                   trans_;
+    vector<int32_t>                                   finality_;
+    std::unordered_map<vector<int>, int, ClosureHash> stateIdx_;
+
+    int         numFlushes_  = 0;
+    int         numThrashes_ = 0; // successive flushes with few steps
+    size_t      numSteps_    = 0; // steps since last flush
+    bool        isFallback_  = false;
+    vector<int> visited_; // time-stamped, for closure
+    int         stamp_ = 0;
+
+    int  build(int state, unsigned char c);
+    int  addState(vector<int> &closure);
+    void flush();
+};
 } // namespace krill::automata
 
 #endif
\ No newline at end of file
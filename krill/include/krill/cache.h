@@ -0,0 +1,54 @@
+#ifndef CACHE_H
+#define CACHE_H
+#include "automata.h"
+#include "defs.h"
+#include "lexical.h"
+#include <cstdint>
+#include <string>
+using krill::type::DFAtable, krill::type::KeywordTable;
+using std::string;
+
+namespace krill::cache {
+
+// bump it whenever a compiled DFA may change for the same patterns
+// (regex dialect, DFA construction or the file layout), old files are
+// then never hit and get evicted in time
+const uint32_t DFA_CACHE_VERSION = 2;
+
+// on-disk cache of compiled lexical DFAs in a local directory, files are
+// content-addressed by hash of the pattern text and DFA_CACHE_VERSION,
+// and evicted least-recently-used first (by mtime) beyond the size cap
+class DFAcache {
+  public:
+    DFAcache(string dir, uintmax_t maxBytes = 64 << 20);
+
+    // false if missed (or file broken), outputs are left unchanged then
+    bool load(const string &key, DFAtable &table, KeywordTable &keywords);
+    void store(const string &key, const DFAtable &table,
+               const KeywordTable &keywords);
+    void clear();
+
+    const string &dir() const { return dir_; }
+    int numHits() const { return numHits_; }
+    int numMisses() const { return numMisses_; }
+    int numEvictions() const { return numEvictions_; }
+
+  private:
+    string    dir_;
+    uintmax_t maxBytes_;
+    int       numHits_      = 0;
+    int       numMisses_    = 0;
+    int       numEvictions_ = 0;
+
+    string getPath(const string &key) const;
+    void   evict();
+};
+
+// cache used by LexicalParser(vector<string>), nullptr for no cache;
+// set from environment variable KRILL_CACHE_DIR at first, if given
+DFAcache *getDefaultCache();
+// empty dir for no cache
+void setDefaultCache(string dir, uintmax_t maxBytes = 64 << 20);
+
+} // namespace krill::cache
+#endif
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 using krill::type::Grammar, krill::type::ActionTable, krill::type::DFA;
+using krill::type::DFAtable, krill::type::KeywordTable;
 using std::map, std::string, std::ostream, std::vector;
 
 namespace krill::codegen {
@@ -13,9 +14,14 @@ namespace krill::codegen {
 void genActionTable(const ActionTable &actionTable, ostream &oss);
 void genGrammar(const Grammar& grammar, ostream &oss);
 void genDFA(const DFA &dfa, ostream &oss);
+void genDFAtable(const DFAtable &table, ostream &oss);
+void genDFAdirect(const DFAtable &table, const KeywordTable &keywords,
+                  ostream &oss);
+void genKeywordTable(const KeywordTable &keywords, ostream &oss);
 
 void genSyntaxParser(const Grammar& grammar, ostream &oss);
 void genLexicalParser(const vector<string> &regexs, ostream &oss);
+void genLexicalParserDirect(const vector<string> &regexs, ostream &oss);
 
 // void genSyntaxParserInCppStyle(const Grammar & grammar, const ActionTable &actionTable, )
 } // namespace krill::codegen
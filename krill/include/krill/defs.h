@@ -21,6 +21,8 @@ namespace krill {
         // automata
         struct DFA;
         struct NFA;
+        struct DFAtable;
+        struct DFAaccel;
         struct Edge;
         using EdgeTable = std::vector<Edge>;
         const int EMPTY_SYMBOL = 0;
@@ -34,6 +36,9 @@ namespace krill {
 
         // lexical
         struct Token;
+        struct TokenView;
+        struct TokenBuffer;
+        struct KeywordTable;
         extern const Token END_TOKEN;
 
         // syntax
@@ -45,6 +50,7 @@ namespace krill {
     namespace utils {}
     namespace codegen {}
     namespace runtime {}
+    namespace cache {}
     namespace minic {}
     namespace error {
         class parse_error : public std::runtime_error {
@@ -59,6 +65,11 @@ namespace krill {
             ~parse_error() throw();
             virtual const char *what() const throw();
         };
+        // DFA construction went beyond its state budget
+        class state_budget_error : public std::runtime_error {
+          public:
+            using std::runtime_error::runtime_error;
+        };
     }
 
 } // namespace krill
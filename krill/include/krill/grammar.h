@@ -5,6 +5,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 using std::pair, std::set, std::map, std::multimap, std::vector;
 using std::string;
@@ -93,26 +94,70 @@ struct ProdLR1Item {
     bool operator==(const ProdLR1Item &p) const;
 };
 
-// Set of LR1 Production Item {(P -> A·b, a), (S -> Sb·, b), }
-using LR1State = set<ProdLR1Item>;
-// string to_string(const LR1State &state, const map<int, string> &symbolNames);
+// set of small integers (dense ids), as bits
+struct Bitset {
+    vector<uint64_t> words;
+
+    Bitset(int size = 0) : words((size + 63) / 64, 0) {}
+    bool count(int i) const { return (words[i >> 6] >> (i & 63)) & 1; }
+    void insert(int i) { words[i >> 6] |= (uint64_t) 1 << (i & 63); }
+    bool merge(const Bitset &b); // return true if changed
+    bool empty() const;
+    template <typename Func> void forEach(Func func) const {
+        for (int w = 0; w < words.size(); w++) {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                func(w * 64 + __builtin_ctzll(bits));
+            }
+        }
+    }
+    bool operator==(const Bitset &b) const { return words == b.words; }
+    bool operator<(const Bitset &b) const { return words < b.words; }
+};
+
+// Set of LR1 Production Item, as core items with their search symbols
+// {(P -> A·b, {a, b}), (S -> Sb·, {b}), }
+// search symbols are the dense terminal ids of GrammarIndex
+using LR1State = map<ProdItem, Bitset>;
+
+struct LR1StateHash {
+    size_t operator()(const LR1State &state) const;
+};
 
 // LR1 Automata (LR1 states, EdgeTable)
 struct LR1Automata {
     vector<LR1State> states;
     EdgeTable        edgeTable;
+    vector<int>      terminals; // {dense id of search symbol, terminal}
+};
+
+// Grammar in dense form, built once and shared by the LR algorithms
+// symbols are renumbered as ids: END_SYMBOL is 0, then terminals, then
+// nonterminals (both ascending)
+struct GrammarIndex {
+    int                          numTerminals; // END_SYMBOL included
+    vector<int>                  symbols;      // {id, symbol}
+    std::unordered_map<int, int> ids;          // {symbol, id}
+    vector<vector<int>>          rights;       // {pidx, ids of right}
+    vector<vector<int>>          prodsOf;      // {id, pidxs of the left id}
+    vector<bool>                 isNullable;   // {id, nullable}
+    vector<Bitset>               firstSets;    // {id, FIRST - {ε}}
+    // FIRST and nullability of suffix right[dot..] of each production
+    vector<vector<Bitset>> suffixFirstSets;  // {pidx, {dot, FIRST - {ε}}}
+    vector<vector<bool>>   isSuffixNullable; // {pidx, {dot, nullable}}
+
+    GrammarIndex(const Grammar &grammar);
+    bool isTerminal(int id) const { return id < numTerminals; }
 };
 
 map<int, set<int>> getFirstSets(Grammar grammar);
 map<int, set<int>> getFollowSets(Grammar grammar, map<int, set<int>> firstSets);
 
-LR1State getLR1StateExpanded(const LR1State &          states,
-                             const map<int, set<int>> &followSets,
-                             const Grammar &           grammar);
+LR1State getLR1StateExpanded(const LR1State &state, const GrammarIndex &index);
 
 LR1Automata getLR1automata(Grammar grammar);
 ActionTable getLR1table(Grammar grammar, LR1Automata lr1Automata);
 LR1Automata getLALR1fromLR1(Grammar grammar, LR1Automata lr1Automata);
+LR1Automata getLALR1automata(Grammar grammar); // without LR1 Automata
 
 string to_string(const map<int, set<int>> firstSets, const Grammar &grammar);
 string to_string(const ProdItem &item, const Grammar &grammar);
@@ -3,11 +3,20 @@
 #include "defs.h"
 #include "automata.h"
 #include "grammar.h"
+#include "regex.h"
+#include <cstdint>
+#include <functional>
 #include <istream>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
-using krill::type::Token, krill::type::DFA;
-using std::vector, std::string, std::istream;
+using krill::type::Token, krill::type::TokenView, krill::type::TokenBuffer;
+using krill::type::KeywordTable;
+using krill::type::DFA, krill::type::DFAtable, krill::type::DFAaccel;
+using krill::automata::LazyDFA;
+using krill::regex::GlushkovVM;
+using std::vector, std::string, std::string_view, std::istream;
 
 namespace krill::type {
 
@@ -21,25 +30,204 @@ struct Token {
     bool operator!=(const Token &t) const;
 };
 
+struct TokenView {
+    // lexical token, located in the parsed buffer (no copy of lval)
+    int    id;
+    size_t offset;
+    size_t length;
+    string_view lval(string_view buffer) const {
+        return buffer.substr(offset, length);
+    }
+};
+
+struct TokenBuffer {
+    // lexical tokens in columns (structure of arrays)
+    vector<int>    ids;
+    vector<size_t> offsets;
+    vector<size_t> lengths;
+
+    size_t size() const { return ids.size(); }
+    void   reserve(size_t n) {
+        ids.reserve(n);
+        offsets.reserve(n);
+        lengths.reserve(n);
+    }
+    void clear() {
+        ids.clear();
+        offsets.clear();
+        lengths.clear();
+    }
+    void push_back(const TokenView &token) {
+        ids.push_back(token.id);
+        offsets.push_back(token.offset);
+        lengths.push_back(token.length);
+    }
+    TokenView operator[](size_t i) const { return {ids[i], offsets[i], lengths[i]}; }
+};
+
+// gperf-style hash on length, first and last byte, seeded for perfect hash
+inline uint32_t getKeywordHash(string_view key, uint32_t seed) {
+    // multiply before each xor, otherwise collisions on size ^ front
+    // byte are independent of the seed
+    uint32_t h = (seed ^ (uint32_t) key.size()) * 16777619u;
+    h = (h ^ (unsigned char) key.front()) * 16777619u;
+    h = (h ^ (unsigned char) key.back()) * 16777619u;
+    return h ^ (h >> 15);
+}
+
+struct KeywordTable {
+    // literal keywords split off the lexical DFA, recognized by their host
+    // (identifier) rule at first, then picked out by a perfect hash
+    uint32_t       seed = 0;
+    vector<int>    ids;    // {slot, lexical id of keyword}, -1 for empty slot
+    vector<int>    hosts;  // {slot, lexical id of host rule}, -1 for empty slot
+    vector<string> keys;   // {slot, keyword}
+    vector<bool>   isHost; // {lexical id, has keywords}
+
+    // return lexical id of keyword if lexeme of host rule is a keyword
+    int find(int id, string_view lexeme) const {
+        if (id < 0 || id >= (int) isHost.size() || !isHost[id]) { return id; }
+        size_t slot = getKeywordHash(lexeme, seed) & (ids.size() - 1);
+        return (hosts[slot] == id && keys[slot] == lexeme) ? ids[slot] : id;
+    }
+};
+
 } // namespace krill::type
 
 namespace krill::runtime {
 
+// state budget of a single rule's DFA, 0 for no limit
+// a rule beyond it (like (a|b)*a(a|b)^20) is run by GlushkovVM instead
+inline int maxRuleStates = 1 << 14;
+
+// integrated DFA of regexs, with literal keyword rules (like "while")
+// split off into a keyword table if a later rule (like identifier) always
+// recognizes them instead, lexical ids are kept
+// rules beyond maxRuleStates are left out into vmRules, or throw
+// runtime_error if vmRules is nullptr
+pair<DFA, KeywordTable> getDFAwithKeywords(const vector<string> &regexs,
+                                           vector<int> *vmRules = nullptr);
+// the same compiled into table, loaded from the default DFA cache if
+// there (see cache.h), or stored into it
+pair<DFAtable, KeywordTable>
+getDFAtableWithKeywords(const vector<string> &regexs,
+                        vector<int> *vmRules = nullptr);
+
+// callback of push-style lexing, lval is valid only during the call
+using TokenFunc = std::function<void(int id, string_view lval)>;
+inline TokenFunc defaultTokenFunc = [](int id, string_view lval) {};
+
 class LexicalParser {
   public:
+    TokenFunc tokenFunc_ = defaultTokenFunc;
+
     LexicalParser() = default;
-    LexicalParser(DFA dfai);
+    LexicalParser(DFA dfai, KeywordTable keywords = {});
+    LexicalParser(DFAtable table, KeywordTable keywords = {});
     LexicalParser(vector<DFA> dfas);
     LexicalParser(vector<string> regexs);
+    // lazy DFA mode, states are built on demand, for huge rule sets;
+    // each copy owns its state cache, which is changed even by const
+    // methods, so a lazy parser must not be shared between threads
+    LexicalParser(vector<string> regexs, bool lazy);
+    LexicalParser(LazyDFA lazy);
 
     Token         parseStep(istream &input);
     vector<Token> parseAll(istream &input);
+    TokenView     parseStep(string_view input, size_t &offset) const;
+    void          parseAll(string_view input, TokenBuffer &tokens) const;
+    void          parseAllParallel(string_view input, TokenBuffer &tokens,
+                                   int threads) const;
+    // push-style, accept partial input and resume mid-token;
+    // tokens are emitted through tokenFunc_, END_TOKEN by finish()
+    void feed(const char *data, size_t size);
+    void finish();
     void clear();
+    // max length of unfinished lexeme kept between feeds
+    void setMaxLexeme(size_t maxLexeme) { maxLexeme_ = maxLexeme; }
+    // skip through self-loop states by ranges scan (on by default),
+    // only for parsing from contiguous buffer
+    void setAccelerated(bool accelerated) {
+        accelerated_ = accelerated && !lazy_;
+    }
 
   protected:
-    DFA    dfa_;
-    int    state_;
-    string history_;
+    DFA      dfa_;
+    DFAtable table_; // compiled from dfa_, used for execution
+    KeywordTable     keywords_;
+    vector<DFAaccel> accels_;  // {state, self-loop ranges}
+    bool             accelerated_ = true;
+    int      state_ = 0;
+    string   lexeme_;  // reused buffer of parseStep(istream &) and feed
+    string   history_; // recent input, for error message
+    size_t   maxLexeme_ = 1 << 16;
+    mutable std::optional<LazyDFA> lazy_; // used instead of table_ if set
+
+    // rules beyond maxRuleStates, run by GlushkovVM in lockstep with the DFA
+    struct VMstate {
+        int                       state = 0; // DFA state, -1 if stuck
+        vector<GlushkovVM::State> vms, next;
+        vector<bool>              isAlive, isNextAlive;
+    };
+    vector<GlushkovVM> vms_;
+    vector<int>        vmIds_; // {vm, lexical id}
+    VMstate            vm_;    // state_ of parseStep(istream &) and feed
+
+    void setVMs(const vector<string> &regexs, const vector<int> &vmRules);
+    void startVM(VMstate &vm) const;
+    // false if all are stuck, then vm is unchanged
+    bool stepVM(VMstate &vm, unsigned char c) const;
+    int  finalityVM(const VMstate &vm) const;
+    // step and finality of state_ (and vm_)
+    bool stepNow(unsigned char c) {
+        if (vms_.empty()) {
+            int next = step(state_, c);
+            if (next >= 0) { state_ = next; }
+            return next >= 0;
+        }
+        return stepVM(vm_, c);
+    }
+    int finalityNow() const {
+        return vms_.empty() ? finality(state_) : finalityVM(vm_);
+    }
+
+    // next state, -1 if cannot continue
+    int step(int state, unsigned char c) const {
+        if (lazy_) { return lazy_->step(state, c); }
+        return table_.trans[state * table_.numClasses + table_.classMap[c]];
+    }
+    int finality(int state) const {
+        return lazy_ ? lazy_->finality(state) : table_.finality[state];
+    }
+    void pushToken(const char *st, const char *ed, int c);
+    bool lexChunk(int &state, const char *base, size_t st, size_t ed,
+                  vector<size_t> &ends, vector<int> &ids) const;
+};
+
+// lexical rules edited one by one (e.g. live reload), without rebuilding
+// the integrated DFA: an added rule is joined by product with its DFA,
+// a removed rule has its acceptance dropped, then only minimized again
+// lexical ids are kept, an added rule has the lowest priority
+class LexicalSpec {
+  public:
+    LexicalSpec(const vector<string> &regexs = {});
+
+    // return lexical id of the rule
+    int  addRule(const string &regex);
+    void removeRule(int id);
+
+    const vector<string> &rules() const { return regexs_; } // "" if removed
+    // the same language as getDFAintegrated of the rules, not minimized
+    DFA           dfa() const;
+    LexicalParser parser() const;
+
+  private:
+    vector<string>      regexs_;
+    vector<bool>        isRemoved_;
+    DFA                 core_;       // finality is label of acceptSets_
+    vector<vector<int>> acceptSets_; // {label, sorted ids of rules accepted}
+
+    void setCore(DFA core, const vector<vector<int>> &acceptSets);
 };
 
 } // namespace krill::runtime
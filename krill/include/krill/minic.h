@@ -38,26 +38,30 @@ class MinicParser {
     MinicSyntaxParser  syntaxParser_;
     MinicLexicalParser lexicalParser_;
 
-    int col_lex_ = 1;
-    int row_lex_ = 1;
-    int col_syn_ = 1;
-    int row_syn_ = 1;
+    int pos_syn_ = 0; // end of last shifted token, for empty production
 
-    stringstream         source_;
-    vector<stringstream> sourceLines_;
+    // consumed source, token positions are byte offsets into it;
+    // newline index is built only when row/col is asked for
+    string              source_;
+    size_t              cursor_     = 0;
+    mutable vector<int> lineStarts_ = {0};
+    mutable size_t      indexed_    = 0;
 
     shared_ptr<APTnode> root_; // magic, don't touch
     vector<APTnode>     nodes_;
 
-    void    count(char c);
-    APTnode tokenToNode(Token token, istream &input, bool &drop);
+    void    indexLines() const;
+    void    parseToken(int id, int pos, int len);
+    APTnode tokenToNode(int id, int pos, int len, bool &drop);
 
   public:
     MinicParser();
 
-    string getLocatedSource(int colSt, int rowSt, int colEd, int rowEd);
-    void   parseAll(istream &input);
-    void   parseStep(istream &input);
+    // (row, col) of byte offset, 1-based, with tab stops of 8
+    pair<int, int> getLocation(int pos) const;
+    string         getLocatedSource(int posSt, int posEd) const;
+    void           parseAll(istream &input);
+    void           parseStep(istream &input);
 
     shared_ptr<APTnode> getAptNode() const;
     vector<APTnode>     getNodes() const;
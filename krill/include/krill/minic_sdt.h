@@ -27,7 +27,8 @@ struct NameCounter {
 // syntax directed translation parser
 class SdtParser {
   private:
-    APTnode *root_;
+    APTnode *          root_;
+    const MinicParser *parser_; // to locate nodes in source, optional
 
     // domain std::stack, make it easier in sdt
     // notice: declarations will be directly appended onto the back of domain
@@ -56,6 +57,9 @@ class SdtParser {
     Var * find_varible_by_name(const string &varname);
     Func *find_function_by_name(const string &funcname);
 
+    // (row, col) of node, for error message
+    pair<int, int> locate(APTnode *node) const;
+
     // simple parsing
     int           parse_int_literal(APTnode *node);
     vector<int>   parse_init_list(APTnode *node);
@@ -90,7 +94,8 @@ class SdtParser {
     void sdt_break_stmt(APTnode *node, Code &code);
 
   public:
-    SdtParser(APTnode *root) : root_(root){};
+    SdtParser(APTnode *root, const MinicParser *parser = nullptr)
+        : root_(root), parser_(parser){};
     SdtParser &parse();
     Ir         get();
 };
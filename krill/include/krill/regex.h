@@ -7,20 +7,100 @@
 #include <map>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 using krill::type::DFA, krill::type::NFA, krill::type::EdgeTable;
+using krill::type::DFAtable;
 using krill::type::Token, krill::type::Grammar, krill::type::ActionTable;
 using std::string, std::pair, std::vector, std::map, std::stack;
+using std::string_view;
 
 namespace krill::regex {
 
-DFA getDFAfromRegex(string src);
+// how regex is compiled into DFA
+enum class RegexCompiler {
+    kFollowpos, // straight from syntax tree, by followpos (default)
+    kThompson,  // Thompson NFA, then subset construction
+};
+
+// maxStates > 0: throw state_budget_error if DFA goes beyond it
+DFA getDFAfromRegex(string src,
+                    RegexCompiler compiler  = RegexCompiler::kFollowpos,
+                    int           maxStates = 0);
 NFA getNFAfromRegex(string src);
 
+// regex run on its Glushkov automaton, for rules whose DFA is too big
+class GlushkovVM {
+  public:
+    // positions just read, in bits if within 64 positions (bit-parallel)
+    struct State {
+        uint64_t    bits = 0;
+        vector<int> positions; // sorted, if not bit-parallel
+    };
+
+    GlushkovVM() = default;
+    GlushkovVM(string regex);
+
+    State start() const;
+    // false if no position is left (next is undefined then)
+    bool step(const State &state, unsigned char c, State &next) const;
+    bool isFinal(const State &state) const;
+    bool isBitParallel() const { return isBitParallel_; }
+    int  numPositions() const { return numPositions_; }
+
+  private:
+    // position numPositions_ stands for the start (nothing read yet)
+    int                  numPositions_ = 0;
+    bool                 isBitParallel_;
+    vector<vector<int>>  follow_;  // {position, sorted next positions}
+    vector<vector<bool>> accepts_; // {position, {byte, is symbol of it}}
+    vector<bool>         isLast_;  // {position, accepting after it}
+    // bit-parallel: {byte, positions of it} and {chunk, {8 bits, follow}}
+    vector<uint64_t>         byteMask_;
+    vector<vector<uint64_t>> followMask_;
+    uint64_t                 lastMask_ = 0;
+};
+
+// unanchored search of a regex in text, matches are leftmost-longest and
+// not overlapped, empty matches are not reported
+// candidate positions are found by literals every match must have (memmem)
+// or bytes a match can start with (memchr), before running the DFA
+class Searcher {
+  public:
+    static constexpr size_t npos = string_view::npos;
+
+    Searcher(string pattern);
+    // first match at or after pos, {offset, length}, or {npos, 0}
+    pair<size_t, size_t>         find(string_view text, size_t pos = 0) const;
+    vector<pair<size_t, size_t>> findAll(string_view text) const;
+
+  private:
+    DFAtable anchored_;
+    DFAtable unanchored_; // of .*(pattern), empty if not used
+    string   prefix_;     // every match starts with
+    string   required_;   // every match contains
+    int      reqOffset_;  // max offset of required_ in a match, -1 unbounded
+    vector<bool> isFirstByte_; // {byte, a match can start with}
+    int          numFirstBytes_;
+    uint8_t      firstByte_; // the only one, if numFirstBytes_ == 1
+
+    size_t      matchAt(const char *p, const char *ed) const;
+    const char *earliestEnd(const char *p, const char *ed) const;
+};
+
 } // namespace krill::regex
 
 namespace krill::regex::core {
 
+// literals every match of a syntax tree node has, for search prefilters
+struct Literals {
+    bool   isExact = false; // matches only prefix (== suffix)
+    string prefix, suffix;  // every match starts with / ends with
+    string required;        // every match contains
+    int    reqOffset = -1;  // max offset of required in a match, -1 unbounded
+    int    maxLen    = 0;   // max length of a match, -1 unbounded
+};
+
 // you don't use these
 struct Token {
     int    id;
@@ -38,6 +118,13 @@ struct Node {
     set<char> rangeChars;
     Node *    child;
     int       st, ed;
+    // first NFA node, NFA edge and position of the subtree, for copies
+    // made by counted repetition {m,n}
+    int nfaNodeSt, nfaEdgeSt, posSt;
+    // for followpos construction
+    bool        nullable;
+    vector<int> firstpos, lastpos; // sorted positions
+    Literals    literals;
 };
 
 class RegexParser {
@@ -53,18 +140,31 @@ class RegexParser {
     EdgeTable nfaEdges;    // {{symbol, from, to}}
     int       numNfaNodes; // leave 0 for global start, 1 for global end
 
+    // positions (leaves of syntax tree) of followpos construction
+    vector<vector<int>> posSymbols_; // {position, sorted symbols}
+    vector<vector<int>> followpos_;  // {position, sorted next positions}
+
     int  posTokens_;
     bool isAccepted_;
 
     void lexicalParse();
     void syntaxParse();
+    void reducePositions(int prodIdx, const vector<Node> &child, Node &node);
+    void reduceLiterals(int prodIdx, const vector<Node> &child, Node &node);
 
   public:
     RegexParser(string regex);
 
     // bool match(string src);
     NFA nfa();
-    DFA dfa();
+    DFA dfa(int maxStates = 0);
+    DFA followposDfa(int maxStates = 0);
+    Literals literals() const { return nodes_.top().literals; }
+
+    // positions of followpos construction, and root of syntax tree
+    const vector<vector<int>> &posSymbols() const { return posSymbols_; }
+    const vector<vector<int>> &followpos() const { return followpos_; }
+    const Node                &root() const { return nodes_.top(); }
 };
 
 } // namespace krill::regex::core
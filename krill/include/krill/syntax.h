@@ -8,12 +8,13 @@
 #include <ostream>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <vector>
 using krill::type::Grammar, krill::type::ActionTable;
-using krill::type::Token, krill::type::APTnode;
+using krill::type::Token, krill::type::TokenBuffer, krill::type::APTnode;
 using krill::utils::AttrDict;
 using std::shared_ptr;
-using std::string, std::ostream;
+using std::string, std::string_view, std::ostream;
 using std::vector, std::deque, std::stack;
 
 namespace krill::type {
@@ -47,6 +48,7 @@ class SyntaxParser {
     void parseStep(APTnode tokenWithAttr);
     void parseAll(vector<Token> tokens);
     void parseAll(vector<APTnode> tokensWithAttr);
+    void parseAll(const TokenBuffer &tokens, string_view source);
 
     shared_ptr<APTnode> getAPT();
     string getAPTstr();
@@ -66,7 +68,12 @@ class SyntaxParser {
     string history_;
 
     void   parse();
-    string getErrorMessage();
+    void   shift(int tgt, shared_ptr<APTnode> node);
+    void   reduce(int pidx);
+    void   accept();
+    void   error(APTnode &input);
+    void   logState(int lookId);
+    string getErrorMessage(const APTnode &input);
 };
 
 string getAPTstr(const shared_ptr<APTnode> &root, const Grammar &grammar);
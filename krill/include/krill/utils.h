@@ -2,7 +2,9 @@
 #define UTILS_H
 #include "magic_enum.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <exception>
 #include <functional>
 #include <map>
 #include <numeric>
@@ -11,6 +13,7 @@
 #include <sstream>
 #include <stack>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <type_traits>
 #include <vector>
@@ -336,6 +339,42 @@ struct ToString {
     }
 };
 
+// threads used by parallel_for, hardware concurrency by default
+inline int &parallel_threads() {
+    static int threads = std::max(1u, std::thread::hardware_concurrency());
+    return threads;
+}
+
+// call func(i) for i in [0, n) on parallel_threads() threads, in no
+// particular order, so func should only write slot i of its outputs;
+// the first exception thrown is rethrown after all threads joined
+template <typename F> inline void parallel_for(size_t n, F func) {
+    size_t numThreads = std::min<size_t>(parallel_threads(), n);
+    if (numThreads <= 1) {
+        for (size_t i = 0; i < n; i++) { func(i); }
+        return;
+    }
+    std::atomic<size_t>      next(0);
+    std::exception_ptr       error;
+    std::atomic<bool>        hasError(false);
+    std::vector<std::thread> workers;
+    auto                     work = [&]() {
+        for (size_t i = next++; i < n && !hasError; i = next++) {
+            try {
+                func(i);
+            } catch (...) {
+                if (!hasError.exchange(true)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    for (size_t t = 1; t < numThreads; t++) { workers.emplace_back(work); }
+    work();
+    for (auto &worker : workers) { worker.join(); }
+    if (error) { std::rethrow_exception(error); }
+}
+
 #define COLOR_RESET   "\033[0m"
 #define COLOR_BLACK   "\033[30m"      /* Black */
 #define COLOR_RED     "\033[31m"      /* Red */
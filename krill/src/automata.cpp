@@ -1,7 +1,10 @@
 #include "krill/automata.h"
+#include "krill/utils.h"
 #include <algorithm>
+#include <cassert>
 #include <queue>
 #include <tuple>
+#include <unordered_map>
 #include <sstream>
 using std::max, std::min;
 using std::stringstream, std::string;
@@ -41,8 +44,8 @@ DFA getMinimizedDfa(DFA dfa) {
 
 // 将NFA转为DFA
 // 采用默认方式确定覆盖片(DFA节点)的可终结属性
-DFA getDFAfromNFA(NFA nfa) {
-    auto[dfaGraph, closureMap] = getClosureMapfromNFAgraph(nfa.graph);
+DFA getDFAfromNFA(const NFA &nfa, int maxStates) {
+    auto[dfaGraph, closureMap] = getClosureMapfromNFAgraph(nfa.graph, maxStates);
     auto finality = getFinalityFromClosureMap(nfa.finality, closureMap);
     return DFA({dfaGraph, finality});
 }
@@ -51,16 +54,110 @@ DFA getDFAfromNFA(NFA nfa) {
 // 返回的大DFA的finality指示从原先第几个DFA的退出
 // 原先的DFA的finality的含义被抹去
 DFA getDFAintegrated(vector<DFA> dfas) {
-    for (int i = 0; i < dfas.size(); i++) {
+    // 各DFA互相独立, 并行最小化
+    krill::utils::parallel_for(dfas.size(), [&dfas](size_t i) {
         dfas[i] = getMinimizedDfa(dfas[i]);
         for (auto it = dfas[i].finality.begin(); it != dfas[i].finality.end();
              it++) {
             if (it->second != 0) { it->second = i + 1; }
         }
-    }
+    });
     return getMinimizedDfa(_getDFAintegrated(dfas));
 }
 
+// 将DFA编译为稠密的跳转表
+// 状态重新编号为 0 ~ numStates-1 (起始状态仍为0), 符号按字节解释
+// 跳转表的列为字节等价类 (见 getByteClasses)
+DFAtable getDFAtable(const DFA &dfa) {
+    // 收集全部状态, 起始状态0排在最前
+    map<int, int> stateId({{0, 0}});
+    auto          assignId = [&stateId](int state) {
+        if (stateId.count(state) == 0) {
+            int id          = stateId.size();
+            stateId[state] = id;
+        }
+    };
+    for (const auto &elem : dfa.finality) { assignId(elem.first); }
+    for (const auto &node : dfa.graph) {
+        assignId(node.first);
+        for (const auto &edge : node.second) { assignId(edge.second); }
+    }
+
+    DFAtable table;
+    table.numStates  = stateId.size();
+    table.classMap   = getByteClasses(dfa);
+    table.numClasses = 1 + *max_element(table.classMap.begin(),
+                                        table.classMap.end());
+    table.trans.assign(table.numStates * table.numClasses, -1);
+    table.finality.assign(table.numStates, 0);
+    for (const auto &node : dfa.graph) {
+        int from = stateId.at(node.first);
+        for (const auto &edge : node.second) {
+            if (edge.first == EMPTY_SYMBOL) { continue; }
+            int cls = table.classMap[(unsigned char) edge.first];
+            table.trans[from * table.numClasses + cls] =
+                stateId.at(edge.second);
+        }
+    }
+    for (const auto &elem : dfa.finality) {
+        table.finality[stateId.at(elem.first)] = elem.second;
+    }
+    return table;
+}
+
+// 求字节等价类: 在所有状态下跳转都相同的字节归为一类
+// 返回 {byte, class}, 类按首次出现的字节顺序编号 (字节0总属于类0)
+vector<uint8_t> getByteClasses(const DFA &dfa) {
+    // 每个字节的列: 各状态下该字节的跳转目标
+    vector<vector<pair<int, int>>> columns(256);
+    for (const auto &node : dfa.graph) {
+        for (const auto &edge : node.second) {
+            if (edge.first == EMPTY_SYMBOL) { continue; }
+            assert(-128 <= edge.first && edge.first < 256);
+            unsigned char byte = (unsigned char) edge.first;
+            columns[byte].push_back({node.first, edge.second});
+        }
+    }
+    // 相同的列合并为同一类
+    vector<uint8_t>                    classMap(256);
+    map<vector<pair<int, int>>, int> columnClass;
+    for (int byte = 0; byte < 256; byte++) {
+        auto it = columnClass.find(columns[byte]);
+        if (it == columnClass.end()) {
+            int cls = columnClass.size();
+            it      = columnClass.insert({columns[byte], cls}).first;
+        }
+        classMap[byte] = it->second;
+    }
+    return classMap;
+}
+
+// 求可加速状态: 自环字节集合可表示为不超过4个字节区间的状态
+// 返回 {state, 自环区间}, 不可加速的状态区间数为0
+vector<DFAaccel> getDFAaccels(const DFAtable &table) {
+    vector<DFAaccel> accels(table.numStates);
+    for (int state = 0; state < table.numStates; state++) {
+        const int32_t *row = &table.trans[state * table.numClasses];
+        DFAaccel       accel;
+        bool           isOk = true;
+        for (int byte = 0; byte < 256 && isOk; byte++) {
+            if (row[table.classMap[byte]] != state) { continue; }
+            // 与上一区间相连则延伸, 否则开始新区间
+            if (accel.numRanges > 0 &&
+                accel.hi[accel.numRanges - 1] + 1 == byte) {
+                accel.hi[accel.numRanges - 1] = byte;
+            } else if (accel.numRanges < 4) {
+                accel.lo[accel.numRanges] = byte;
+                accel.hi[accel.numRanges] = byte;
+                accel.numRanges++;
+            } else {
+                isOk = false;
+            }
+        }
+        if (isOk) { accels[state] = accel; }
+    }
+    return accels;
+}
 
 // EdgeTabel => NFAgraph
 NFAgraph toNFAgraph(EdgeTable edgeTable) {
@@ -71,6 +168,41 @@ NFAgraph toNFAgraph(EdgeTable edgeTable) {
     return nfa;
 }
 
+// NFAgraph => NFAcsr
+NFAcsr toNFAcsr(const NFAgraph &nfaGraph) {
+    NFAcsr csr;
+    csr.stateId.push_back(0);
+    for (const auto &[from, edges] : nfaGraph) {
+        csr.stateId.push_back(from);
+        for (const auto &[symbol, to] : edges) { csr.stateId.push_back(to); }
+    }
+    std::sort(csr.stateId.begin(), csr.stateId.end());
+    csr.stateId.erase(std::unique(csr.stateId.begin(), csr.stateId.end()),
+                      csr.stateId.end());
+    auto indexOf = [&csr](int state) -> int {
+        return std::lower_bound(csr.stateId.begin(), csr.stateId.end(), state) -
+               csr.stateId.begin();
+    };
+
+    csr.offsets.assign(csr.stateId.size() + 1, 0);
+    for (const auto &[from, edges] : nfaGraph) {
+        csr.offsets[indexOf(from) + 1] = edges.size();
+    }
+    for (int i = 0; i < csr.stateId.size(); i++) {
+        csr.offsets[i + 1] += csr.offsets[i];
+    }
+    csr.symbols.resize(csr.offsets.back());
+    csr.targets.resize(csr.offsets.back());
+    for (const auto &[from, edges] : nfaGraph) {
+        int j = csr.offsets[indexOf(from)];
+        for (const auto &[symbol, to] : edges) {
+            csr.symbols[j]   = symbol;
+            csr.targets[j++] = indexOf(to);
+        }
+    }
+    return csr;
+}
+
 // EdgeTabel => DFAgraph
 DFAgraph toDFAgraph(EdgeTable edgeTable) {
     DFAgraph dfa;
@@ -96,49 +228,126 @@ EdgeTable toEdgeTable(DFAgraph dfa) {
 // 由于覆盖片中各节点可能拥有不同可终结属性, 覆盖片(DFA节点)的可终结属性无法确定
 // 返回DFA和覆盖片，其中覆盖片记录了DFA-NFA节点映射关系
 // 不负责处理转换后的可终结属性
-pair<DFAgraph, ClosureMap> getClosureMapfromNFAgraph(NFAgraph nfaGraph) {
-    vector<set<int>> closures; // dfa节点对原nfa节点的映射
-    DFAgraph         dfaGraph;
+// 覆盖片以有序数组表示, 经哈希表驻留 (ClosureHash), 每个覆盖片仅查找一次
+// maxStates > 0 时, 覆盖片超出该数目即抛出 state_budget_error
+pair<DFAgraph, ClosureMap> getClosureMapfromNFAgraph(const NFAgraph &nfaGraph,
+                                                     int maxStates) {
+    NFAcsr nfa = toNFAcsr(nfaGraph);
+    int    n   = nfa.stateId.size();
+
+    // epsilon-闭包, 用时间戳标记访问过的状态, 避免每次清空
+    // 每个线程一份 (Scratch)
+    struct Scratch {
+        vector<int>            visited, stack;
+        int                    stamp = 0;
+        vector<pair<int, int>> moves; // {symbol, next}
+    };
+    auto expand = [&nfa](Scratch &sc, vector<int> &closure) {
+        sc.stamp++;
+        for (int state : closure) { sc.visited[state] = sc.stamp; }
+        sc.stack.assign(closure.begin(), closure.end());
+        while (sc.stack.size()) {
+            int current = sc.stack.back();
+            sc.stack.pop_back();
+            for (int j = nfa.offsets[current]; j < nfa.offsets[current + 1];
+                 j++) {
+                int next = nfa.targets[j];
+                if (nfa.symbols[j] == EMPTY_SYMBOL &&
+                    sc.visited[next] != sc.stamp) {
+                    sc.visited[next] = sc.stamp;
+                    closure.push_back(next);
+                    sc.stack.push_back(next);
+                }
+            }
+        }
+        std::sort(closure.begin(), closure.end());
+    };
+    int             numThreads = krill::utils::parallel_threads();
+    vector<Scratch> scratches(numThreads);
+    for (Scratch &sc : scratches) { sc.visited.assign(n, -1); }
+
+    vector<vector<int>>                               closures;
+    std::unordered_map<vector<int>, int, ClosureHash> closureIdx;
+    DFAgraph                                          dfaGraph;
+    auto intern = [&](vector<int> &closure) -> int {
+        auto [it, isNew] = closureIdx.emplace(closure, closures.size());
+        if (isNew) { closures.push_back(std::move(closure)); }
+        if (maxStates > 0 && closures.size() > maxStates) {
+            throw krill::error::state_budget_error(fmt::format(
+                "DFA goes beyond {} states in subset construction",
+                maxStates));
+        }
+        return it->second;
+    };
 
     // 构造初始覆盖片
-    set<int> initClosure({0});
-    setClosureExpanded(initClosure, nfaGraph);
-    closures.push_back(initClosure);
-
-    // bfs, 产生新覆盖片
-    for (int closureIdx = 0; (size_t) closureIdx < closures.size();
-         closureIdx++) {
-        set<int> closure = closures[closureIdx];
-
-        set<int> nextSymbols;
-        for (int state : closure) {
-            for (const auto &node : nfaGraph[state]) {
-                nextSymbols.insert(node.first);
+    vector<int> initClosure({int(
+        std::lower_bound(nfa.stateId.begin(), nfa.stateId.end(), 0) -
+        nfa.stateId.begin())});
+    expand(scratches[0], initClosure);
+    intern(initClosure);
+
+    // 覆盖片的后继: {symbol, next closure}, 按符号升序
+    auto getSuccessors = [&](Scratch &sc, int idx) {
+        vector<pair<int, vector<int>>> successors;
+        sc.moves.clear();
+        for (int state : closures[idx]) {
+            for (int j = nfa.offsets[state]; j < nfa.offsets[state + 1]; j++) {
+                if (nfa.symbols[j] != EMPTY_SYMBOL) {
+                    sc.moves.push_back({nfa.symbols[j], nfa.targets[j]});
+                }
+            }
+        }
+        std::sort(sc.moves.begin(), sc.moves.end());
+        sc.moves.erase(std::unique(sc.moves.begin(), sc.moves.end()),
+                       sc.moves.end());
+        for (int i = 0, j; i < sc.moves.size(); i = j) {
+            vector<int> nextClosure;
+            for (j = i; j < sc.moves.size() &&
+                        sc.moves[j].first == sc.moves[i].first;
+                 j++) {
+                nextClosure.push_back(sc.moves[j].second);
             }
+            expand(sc, nextClosure);
+            successors.push_back({sc.moves[i].first, std::move(nextClosure)});
         }
-        // 对覆盖片步进，产生新覆盖片
-        map<int, set<int>> nextClosures = getNextClosures(closure, nfaGraph);
-        for (const auto &elem : nextClosures) {
-            int      symbol      = elem.first;
-            set<int> nextClosure = elem.second;
-
-            if (symbol == EMPTY_SYMBOL) { continue; }
-            // 为覆盖片分配下一个idx，加入
-            auto it = find(closures.begin(), closures.end(), nextClosure);
-            int  nextClosureIdx = (int) (it - closures.begin());
-            if ((size_t) nextClosureIdx == closures.size()) {
-                closures.push_back(nextClosure); // 无重复, 先生成新覆盖片
+        return successors;
+    };
+
+    // 逐层bfs: 同一层覆盖片的后继并行求出, 再按 (覆盖片, 符号) 升序
+    // 依次驻留分配编号, 编号与串行bfs一致, 与线程数无关
+    vector<vector<pair<int, vector<int>>>> layer;
+    for (int lo = 0, hi; lo < closures.size(); lo = hi) {
+        hi = closures.size();
+        layer.assign(hi - lo, {});
+        // 层太小时不值得开线程
+        int numChunks = std::min<int>(numThreads, (hi - lo) / 16);
+        if (numChunks <= 1) {
+            for (int idx = lo; idx < hi; idx++) {
+                layer[idx - lo] = getSuccessors(scratches[0], idx);
+            }
+        } else {
+            krill::utils::parallel_for(numChunks, [&](size_t t) {
+                for (int idx = lo + t; idx < hi; idx += numChunks) {
+                    layer[idx - lo] = getSuccessors(scratches[t], idx);
+                }
+            });
+        }
+        for (int idx = lo; idx < hi; idx++) {
+            if (layer[idx - lo].empty()) { continue; }
+            auto &edges = dfaGraph[idx];
+            for (auto &[symbol, nextClosure] : layer[idx - lo]) {
+                edges[symbol] = intern(nextClosure);
             }
-            dfaGraph[closureIdx][symbol] = nextClosureIdx;
         }
     }
 
     // 格式转换, closures -> closureMap
-    map<int, set<int>> closureMap;
-    for (int closureIdx = 0; (size_t) closureIdx < closures.size();
-         closureIdx++) {
-        for (int nfaState : closures[closureIdx]) {
-            closureMap[closureIdx].insert(nfaState);
+    ClosureMap closureMap;
+    for (int idx = 0; idx < closures.size(); idx++) {
+        Closure &closure = closureMap[idx];
+        for (int state : closures[idx]) {
+            closure.insert(closure.end(), nfa.stateId[state]);
         }
     }
 
@@ -150,15 +359,15 @@ pair<DFAgraph, ClosureMap> getClosureMapfromNFAgraph(NFAgraph nfaGraph) {
 // 每个DFA均以0为起始状态，合并得到唯一起始状态
 // 用不同值标注DFA的节点可终结属性, 可以防止合并
 // (得到的DFA未最小化)
-map<int, int> getFinalityFromClosureMap(map<int, int> nfaFinality,
-                                        ClosureMap    closureMap) {
+map<int, int> getFinalityFromClosureMap(const map<int, int> &nfaFinality,
+                                        const ClosureMap    &closureMap) {
     map<int, int> finality;
     for (const auto &elem : closureMap) {
+        int &curr = finality[elem.first];
         for (int i : elem.second) {
-            finality[elem.first] =
-                min(finality[elem.first], nfaFinality[i]) == 0
-                    ? max(finality[elem.first], nfaFinality[i])
-                    : min(finality[elem.first], nfaFinality[i]);
+            auto it   = nfaFinality.find(i);
+            int  next = (it != nfaFinality.end()) ? it->second : 0;
+            curr      = min(curr, next) == 0 ? max(curr, next) : min(curr, next);
         }
     }
     return finality;
@@ -193,79 +402,174 @@ DFA getReachableDfa(DFA dfa) {
 // 合并DFA等价状态
 // 可终结性相同且跳转等效的节点将会被合并
 // 用不同值标注DFA的节点可终结属性, 可以防止合并
+// Hopcroft 算法, O(n·k·log n), 在稠密数组上进行划分细化
 DFA getMergedDfa(DFA dfa) {
-    // 用不同的整数(id)染色, 区分集合划分
-    // 按可终结属性值的不同进行初次划分
-    map<int, int> stateColor = dfa.finality;
-    // 获取充分染色后DFA节点, 作为区分特征
-    // 对于状态i和状态j,若{stateColor[i], dfa}
-    using DFAnode          = pair<int, map<int, int>>;
-    auto getColoredDFAnode = [&stateColor](DFAnode node) -> DFAnode {
-        node.first = stateColor[node.first];
-        for (auto it = node.second.begin(); it != node.second.end(); it++) {
-            it->second = stateColor[it->second];
-        }
-        return node;
+    // 状态和符号稠密编号, 另加一个陷阱状态 (编号n) 补全缺失的跳转
+    // 陷阱状态单独作为一类, 因此缺失跳转与任何真实跳转都不等效
+    vector<int> states, symbols;
+    for (const auto &[state, _] : dfa.finality) { states.push_back(state); }
+    for (const auto &[from, edges] : dfa.graph) {
+        states.push_back(from);
+        for (const auto &[symbol, to] : edges) {
+            states.push_back(to);
+            symbols.push_back(symbol);
+        }
+    }
+    for (auto *v : {&states, &symbols}) {
+        std::sort(v->begin(), v->end());
+        v->erase(std::unique(v->begin(), v->end()), v->end());
+    }
+    auto indexOf = [](const vector<int> &v, int x) -> int {
+        return std::lower_bound(v.begin(), v.end(), x) - v.begin();
     };
+    int n = states.size(), k = symbols.size(), N = n + 1;
+
+    // 逆向跳转 (CSR): {symbol * N + to, froms}
+    vector<int> next(N * k, n);
+    for (const auto &[from, edges] : dfa.graph) {
+        int i = indexOf(states, from);
+        for (const auto &[symbol, to] : edges) {
+            next[indexOf(symbols, symbol) * N + i] = indexOf(states, to);
+        }
+    }
+    vector<int> invHead(N * k + 1, 0), invFrom(N * k);
+    for (int a = 0; a < k; a++) {
+        for (int i = 0; i < N; i++) { invHead[a * N + next[a * N + i] + 1]++; }
+    }
+    for (int j = 0; j < N * k; j++) { invHead[j + 1] += invHead[j]; }
+    vector<int> invFill(invHead.begin(), invHead.end() - 1);
+    for (int a = 0; a < k; a++) {
+        for (int i = 0; i < N; i++) {
+            invFrom[invFill[a * N + next[a * N + i]]++] = i;
+        }
+    }
 
-    int                    numSplitedStates = 1;
-    map<DFAnode, set<int>> partition;
-    while (true) {
-        // 按后继状态的染色情况是否相同, 进行进一步划分
-        partition = {};
-        for (auto[state, _] : dfa.finality) {
-            auto coloredNode = getColoredDFAnode({state, dfa.graph[state]});
-            partition[coloredNode].insert(state);
-        }
-        // 仅当无更新才结束
-        if (numSplitedStates == partition.size()) { break; }
-        numSplitedStates = partition.size();
-        // 根据划分重新染色
-        int newStateColor = 0;
-        for (auto it = partition.begin(); it != partition.end(); it++) {
-            for (int state : it->second) { stateColor[state] = newStateColor; }
-            newStateColor++;
-        }
-    }
-    // 根据染色, 构建状态替换映射
-    map<int, int> idState;
-    for (const auto &elem : stateColor) {
-        if (idState.count(elem.second) == 0) {
-            idState[elem.second] = elem.first;
-        } else {
-            idState[elem.second] = min(idState[elem.second], elem.first);
+    // 可细化的划分: 每类占据 elems 的一段 [first, end), 其中 [first, mid)
+    // 为本轮被标记的状态
+    vector<int> elems(N), loc(N), blockOf(N);
+    vector<int> first, end, mid;
+    {
+        // 按可终结属性值的不同进行初次划分, 陷阱状态单独一类
+        vector<pair<int, int>> keyed; // {color, state}
+        for (int i = 0; i < n; i++) {
+            auto it = dfa.finality.find(states[i]);
+            keyed.push_back({it != dfa.finality.end() ? it->second : 0, i});
+        }
+        std::sort(keyed.begin(), keyed.end());
+        for (int j = 0; j < n; j++) {
+            if (j == 0 || keyed[j].first != keyed[j - 1].first) {
+                first.push_back(j);
+            }
+            elems[j] = keyed[j].second;
+        }
+        first.push_back(n);
+        elems[n] = n;
+        for (int b = 0; b < first.size(); b++) {
+            end.push_back(b + 1 < first.size() ? first[b + 1] : N);
+            mid.push_back(first[b]);
+            for (int j = first[b]; j < end[b]; j++) {
+                loc[elems[j]]     = j;
+                blockOf[elems[j]] = b;
+            }
         }
     }
-    map<int, int> replaceMap;
-    for (const auto &elem : stateColor) {
-        replaceMap[elem.first] = idState[stateColor[elem.first]];
+
+    // 待处理的 {类, 符号}, 初始加入除最大类以外的所有类
+    vector<pair<int, int>> waiting;
+    vector<char>           isWaiting(first.size() * k, false);
+    int                    largest = 0;
+    for (int b = 0; b < first.size(); b++) {
+        if (end[b] - first[b] > end[largest] - first[largest]) { largest = b; }
     }
-    // 替换
-    EdgeTable edgeTable = toEdgeTable(dfa.graph);
-    for (auto it = edgeTable.begin(); it != edgeTable.end(); it++) {
-        it->from = replaceMap[it->from];
-        it->to   = replaceMap[it->to];
+    for (int b = 0; b < first.size(); b++) {
+        if (b == largest) { continue; }
+        for (int a = 0; a < k; a++) {
+            waiting.push_back({b, a});
+            isWaiting[b * k + a] = true;
+        }
     }
-    DFA resDfa;
-    resDfa.graph = toDFAgraph(edgeTable);
-    map<int, int> resFinality;
-    for (auto it = dfa.finality.begin(); it != dfa.finality.end(); it++) {
-        resDfa.finality[replaceMap[it->first]] = it->second;
-        // printf("{%d, %d} ", replaceMap[it->first], it->second);
+
+    vector<int> splitter, touched;
+    while (waiting.size() > 0) {
+        auto [splitterBlock, a] = waiting.back();
+        waiting.pop_back();
+        isWaiting[splitterBlock * k + a] = false;
+        // 标记会移动 elems, 先复制出当前的类
+        splitter.assign(elems.begin() + first[splitterBlock],
+                        elems.begin() + end[splitterBlock]);
+
+        // 标记所有经符号a跳转入该类的状态
+        touched.clear();
+        for (int to : splitter) {
+            for (int j = invHead[a * N + to]; j < invHead[a * N + to + 1];
+                 j++) {
+                int from = invFrom[j], b = blockOf[from];
+                if (loc[from] < mid[b]) { continue; } // 已标记
+                if (mid[b] == first[b]) { touched.push_back(b); }
+                int other = elems[mid[b]];
+                std::swap(elems[loc[from]], elems[mid[b]]);
+                std::swap(loc[from], loc[other]);
+                mid[b]++;
+            }
+        }
+
+        // 被部分标记的类一分为二, 标记部分成为新类
+        for (int b : touched) {
+            if (mid[b] == end[b]) {
+                mid[b] = first[b];
+                continue;
+            }
+            int nb = first.size();
+            first.push_back(first[b]);
+            end.push_back(mid[b]);
+            mid.push_back(first[b]);
+            first[b] = mid[b];
+            for (int j = first[nb]; j < end[nb]; j++) { blockOf[elems[j]] = nb; }
+            isWaiting.resize(first.size() * k, false);
+            int smaller = (end[nb] - first[nb] <= end[b] - first[b]) ? nb : b;
+            for (int c = 0; c < k; c++) {
+                int added = isWaiting[b * k + c] ? nb : smaller;
+                if (!isWaiting[added * k + c]) {
+                    waiting.push_back({added, c});
+                    isWaiting[added * k + c] = true;
+                }
+            }
+        }
     }
 
+    // 根据划分, 以各类中编号最小的状态代表该类
+    vector<int> blockRep(first.size(), INT32_MAX);
+    for (int i = 0; i < n; i++) {
+        blockRep[blockOf[i]] = min(blockRep[blockOf[i]], states[i]);
+    }
+    auto replace = [&](int state) {
+        return blockRep[blockOf[indexOf(states, state)]];
+    };
+    DFA resDfa;
+    for (const auto &[from, edges] : dfa.graph) {
+        if (edges.size() == 0) { continue; }
+        auto &resEdges = resDfa.graph[replace(from)];
+        for (const auto &[symbol, to] : edges) {
+            resEdges[symbol] = replace(to);
+        }
+    }
+    for (const auto &[state, finality] : dfa.finality) {
+        resDfa.finality[replace(state)] = finality;
+    }
     return resDfa;
 }
 
 // // 扩张覆盖片选择（epsilon-闭包法）
-void setClosureExpanded(Closure &closure, NFAgraph nfaGraph) {
+void setClosureExpanded(Closure &closure, const NFAgraph &nfaGraph) {
     // bfs扩大搜索
     std::queue<int> q;
     for (int state : closure) { q.push(state); }
     while (q.size()) {
         int current = q.front();
         q.pop();
-        for (const auto &elem : nfaGraph[current]) {
+        auto node = nfaGraph.find(current);
+        if (node == nfaGraph.end()) { continue; }
+        for (const auto &elem : node->second) {
             int symbol = elem.first;
             int next   = elem.second;
             if (symbol == EMPTY_SYMBOL && closure.count(next) == 0) {
@@ -277,10 +581,12 @@ void setClosureExpanded(Closure &closure, NFAgraph nfaGraph) {
 }
 
 // 求后继覆盖片
-ClosureMap getNextClosures(Closure closure, NFAgraph nfaGraph) {
+ClosureMap getNextClosures(const Closure &closure, const NFAgraph &nfaGraph) {
     map<int, set<int>> nextClosures;
     for (int current : closure) {
-        for (const auto &edge : nfaGraph[current]) {
+        auto node = nfaGraph.find(current);
+        if (node == nfaGraph.end()) { continue; }
+        for (const auto &edge : node->second) {
             if (edge.first != EMPTY_SYMBOL) {
                 nextClosures[edge.first].insert(edge.second);
             }
@@ -296,11 +602,12 @@ ClosureMap getNextClosures(Closure closure, NFAgraph nfaGraph) {
 // 保留原先的DFA的finality的含义
 // 如果你不明白原理，请使用 getDFAintegrated
 DFA _getDFAintegrated(vector<DFA> dfas) {
-    vector<EdgeTable> edgeTables(dfas.size());
-    for (int i = 0; i < dfas.size(); i++) {
-        edgeTables[i] = toEdgeTable(dfas[i].graph);
-    }
+    return getDFAfromNFA(getNFAintegrated(dfas));
+}
 
+// 将若干个DFA并联为1个NFA (0号状态经空边到达各DFA的起始状态)
+// 保留原先的DFA的finality的含义
+NFA getNFAintegrated(const vector<DFA> &dfas) {
     EdgeTable nfaEdgeTable;
     map<int, int> nfaFinality;
 
@@ -310,21 +617,149 @@ DFA _getDFAintegrated(vector<DFA> dfas) {
     for (int i = 0; i < dfas.size(); i++) {
         // 更新边集合
         nfaEdgeTable.push_back({EMPTY_SYMBOL, 0, numStateAdded});
-        for (Edge &edge : edgeTables[i]) {
+        for (const Edge &edge : toEdgeTable(dfas[i].graph)) {
             nfaEdgeTable.push_back({edge.symbol, edge.from + numStateAdded,
                                     edge.to + numStateAdded});
         }
         // 更新终结状态集合
         for (int state = 0; state < dfas[i].finality.size(); state++) {
-            nfaFinality[state + numStateAdded] = dfas[i].finality[state];
+            nfaFinality[state + numStateAdded] = dfas[i].finality.at(state);
         }
 
         numStateAdded += dfas[i].finality.size();
     }
 
-    NFA nfa = {toNFAgraph(nfaEdgeTable), nfaFinality};
-    DFA dfa = getDFAfromNFA(nfa);
-    return dfa;
+    return NFA({toNFAgraph(nfaEdgeTable), nfaFinality});
+}
+
+// ---------- LazyDFA ----------
+
+LazyDFA::LazyDFA(const NFA &nfa, int maxStates)
+    : nfa_(toNFAcsr(nfa.graph)), maxStates_(std::max(maxStates, 4)) {
+    nfaFinality_.assign(nfa_.stateId.size(), 0);
+    for (int i = 0; i < nfa_.stateId.size(); i++) {
+        auto it = nfa.finality.find(nfa_.stateId[i]);
+        if (it != nfa.finality.end()) { nfaFinality_[i] = it->second; }
+    }
+    visited_.assign(nfa_.stateId.size(), -1);
+    flush();
+}
+
+// 清空缓存, 仅保留起始状态 (编号0)
+void LazyDFA::flush() {
+    closures_.clear();
+    trans_.clear();
+    finality_.clear();
+    stateIdx_.clear();
+    vector<int> initClosure({int(
+        std::lower_bound(nfa_.stateId.begin(), nfa_.stateId.end(), 0) -
+        nfa_.stateId.begin())});
+    stamp_++;
+    visited_[initClosure[0]] = stamp_;
+    for (int i = 0; i < initClosure.size(); i++) {
+        int current = initClosure[i];
+        for (int j = nfa_.offsets[current]; j < nfa_.offsets[current + 1];
+             j++) {
+            int next = nfa_.targets[j];
+            if (nfa_.symbols[j] == EMPTY_SYMBOL && visited_[next] != stamp_) {
+                visited_[next] = stamp_;
+                initClosure.push_back(next);
+            }
+        }
+    }
+    std::sort(initClosure.begin(), initClosure.end());
+    addState(initClosure);
+}
+
+// 驻留覆盖片, 可终结属性取法同 getFinalityFromClosureMap
+int LazyDFA::addState(vector<int> &closure) {
+    auto [it, isNew] = stateIdx_.emplace(closure, closures_.size());
+    if (!isNew) { return it->second; }
+    int finality = 0;
+    for (int i : closure) {
+        int next = nfaFinality_[i];
+        finality = min(finality, next) == 0 ? max(finality, next)
+                                             : min(finality, next);
+    }
+    closures_.push_back(std::move(closure));
+    trans_.resize(closures_.size() * 256, -2);
+    finality_.push_back(finality);
+    return it->second;
+}
+
+// 缓存未命中, 构造后继状态
+int LazyDFA::build(int state, unsigned char c) {
+    // 后继覆盖片 (含epsilon-闭包)
+    vector<int> next;
+    stamp_++;
+    for (int current : closures_[state]) {
+        for (int j = nfa_.offsets[current]; j < nfa_.offsets[current + 1];
+             j++) {
+            int target = nfa_.targets[j];
+            if (nfa_.symbols[j] != EMPTY_SYMBOL &&
+                (unsigned char) nfa_.symbols[j] == c &&
+                visited_[target] != stamp_) {
+                visited_[target] = stamp_;
+                next.push_back(target);
+            }
+        }
+    }
+    for (int i = 0; i < next.size(); i++) {
+        int current = next[i];
+        for (int j = nfa_.offsets[current]; j < nfa_.offsets[current + 1];
+             j++) {
+            int target = nfa_.targets[j];
+            if (nfa_.symbols[j] == EMPTY_SYMBOL && visited_[target] != stamp_) {
+                visited_[target] = stamp_;
+                next.push_back(target);
+            }
+        }
+    }
+    if (next.size() == 0) {
+        if (!isFallback_ || state == 0) { trans_[state * 256 + c] = -1; }
+        return -1;
+    }
+    std::sort(next.begin(), next.end());
+
+    // NFA模拟: 仅缓存起始状态的后继 (编号1+c), 其余覆盖片在编号257,
+    // 258两个状态轮流存放, 不缓存
+    if (isFallback_) {
+        int slot     = (state == 0) ? 1 + c : (state == 257) ? 258 : 257;
+        int finality = 0;
+        for (int i : next) {
+            int f    = nfaFinality_[i];
+            finality = min(finality, f) == 0 ? max(finality, f)
+                                             : min(finality, f);
+        }
+        closures_[slot] = std::move(next);
+        finality_[slot] = finality;
+        if (state == 0) { trans_[c] = slot; }
+        return slot;
+    }
+
+    // 缓存已满, 清空后重新加入当前状态
+    if (closures_.size() >= maxStates_ && stateIdx_.count(next) == 0) {
+        // 平均每个缓存的状态被使用不到16次, 视为抖动; 连续抖动则退化
+        numThrashes_ = (numSteps_ < closures_.size() * 16) ? numThrashes_ + 1
+                                                           : 0;
+        numFlushes_++;
+        numSteps_           = 0;
+        vector<int> current = closures_[state];
+        flush();
+        if (numThrashes_ >= 3) {
+            // 退化为NFA模拟
+            isFallback_ = true;
+            closures_.resize(259);
+            finality_.resize(259);
+            trans_.resize(256);
+            closures_[257] = std::move(current);
+            return build(257, c);
+        }
+        state = addState(current);
+    }
+    int nextState           = addState(next);
+    trans_[state * 256 + c] = nextState;
+    return nextState;
 }
 
 } // namespace krill::automata
\ No newline at end of file
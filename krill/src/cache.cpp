@@ -0,0 +1,282 @@
+#include "krill/cache.h"
+#include "fmt/format.h"
+#include "krill/defs.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+using krill::log::logger;
+using namespace krill::type;
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace krill::cache {
+
+// ---------- file layout ----------
+// "KRDFA" + version, key, DFAtable, KeywordTable, in native byte order
+// strings and arrays are led by their uint32_t size
+
+namespace {
+
+struct Writer {
+    string buf;
+    template <typename T> void put(const T &value) {
+        buf.append((const char *) &value, sizeof(T));
+    }
+    void put(const string &str) {
+        put((uint32_t) str.size());
+        buf.append(str);
+    }
+    template <typename T> void put(const vector<T> &values) {
+        put((uint32_t) values.size());
+        buf.append((const char *) values.data(), values.size() * sizeof(T));
+    }
+};
+
+struct Reader {
+    const char *p, *ed;
+    bool        isOk = true;
+    template <typename T> T get() {
+        T value{};
+        if (ed - p < (ptrdiff_t) sizeof(T)) {
+            isOk = false;
+            return value;
+        }
+        memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+    string getString() {
+        uint32_t size = get<uint32_t>();
+        if (!isOk || ed - p < (ptrdiff_t) size) {
+            isOk = false;
+            return "";
+        }
+        p += size;
+        return string(p - size, size);
+    }
+    template <typename T> vector<T> getVector() {
+        uint32_t size = get<uint32_t>();
+        if (!isOk || (size_t) (ed - p) / sizeof(T) < size) {
+            isOk = false;
+            return {};
+        }
+        vector<T> values(size);
+        memcpy(values.data(), p, size * sizeof(T));
+        p += size * sizeof(T);
+        return values;
+    }
+};
+
+const char MAGIC[] = "KRDFA";
+
+// FNV-1a, 64 bits
+uint64_t getHash(const string &str, uint64_t h = 14695981039346656037ull) {
+    for (unsigned char c : str) { h = (h ^ c) * 1099511628211ull; }
+    return h;
+}
+
+// values in range, so that lexing a loaded table never reads out of
+// bounds; sizes are checked by the reader
+bool isValid(const DFAtable &table, const KeywordTable &keywords) {
+    if (table.numStates < 1 || table.numClasses < 1 ||
+        table.numClasses > 256) {
+        return false;
+    }
+    auto isIn = [](const auto &values, int lo, int hi) {
+        return std::all_of(values.begin(), values.end(),
+                           [&](int v) { return lo <= v && v < hi; });
+    };
+    int numSlots = keywords.ids.size();
+    int numIds   = keywords.isHost.size();
+    return isIn(table.classMap, 0, table.numClasses) &&
+           isIn(table.trans, -1, table.numStates) &&
+           isIn(table.finality, 0, numSlots > 0 ? numIds + 1 : INT_MAX) &&
+           (numSlots & (numSlots - 1)) == 0 &&
+           (int) keywords.hosts.size() == numSlots &&
+           (int) keywords.keys.size() == numSlots &&
+           isIn(keywords.ids, -1, numIds) && isIn(keywords.hosts, -1, numIds);
+}
+
+} // namespace
+
+DFAcache::DFAcache(string dir, uintmax_t maxBytes)
+    : dir_(dir), maxBytes_(maxBytes) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    if (ec) {
+        logger.warn("DFA cache: cannot create directory {}: {}", dir_,
+                    ec.message());
+    }
+}
+
+string DFAcache::getPath(const string &key) const {
+    uint64_t h = getHash(key, getHash(fmt::format("{}{}", MAGIC,
+                                                  DFA_CACHE_VERSION)));
+    return (fs::path(dir_) / fmt::format("{:016x}.dfa", h)).string();
+}
+
+bool DFAcache::load(const string &key, DFAtable &table,
+                    KeywordTable &keywords) {
+    string   path = getPath(key);
+    ifstream file(path, ios::binary);
+    if (!file) {
+        numMisses_++;
+        return false;
+    }
+    stringstream ss;
+    ss << file.rdbuf();
+    string content = ss.str();
+    file.close();
+
+    Reader       reader{content.data(), content.data() + content.size()};
+    DFAtable     table2;
+    KeywordTable keywords2;
+
+    bool isOk = reader.getString() == MAGIC &&
+                reader.get<uint32_t>() == DFA_CACHE_VERSION &&
+                reader.getString() == key;
+    if (isOk) {
+        table2.numStates  = reader.get<int32_t>();
+        table2.numClasses = reader.get<int32_t>();
+        table2.classMap   = reader.getVector<uint8_t>();
+        table2.trans      = reader.getVector<int32_t>();
+        table2.finality   = reader.getVector<int32_t>();
+        keywords2.seed    = reader.get<uint32_t>();
+        keywords2.ids     = reader.getVector<int>();
+        keywords2.hosts   = reader.getVector<int>();
+
+        uint32_t numKeys = reader.get<uint32_t>();
+        for (uint32_t i = 0; i < numKeys && reader.isOk; i++) {
+            keywords2.keys.push_back(reader.getString());
+        }
+        for (uint8_t isHost : reader.getVector<uint8_t>()) {
+            keywords2.isHost.push_back(isHost);
+        }
+        isOk = reader.isOk && reader.p == reader.ed &&
+               table2.classMap.size() == 256 &&
+               table2.trans.size() ==
+                   (size_t) table2.numStates * table2.numClasses &&
+               table2.finality.size() == (size_t) table2.numStates &&
+               isValid(table2, keywords2);
+    }
+    if (!isOk) {
+        // hash collision, truncated by a crashed writer, or corrupted
+        logger.warn("DFA cache: broken file {}, removed", path);
+        std::error_code ec;
+        fs::remove(path, ec);
+        numMisses_++;
+        return false;
+    }
+
+    // mtime marks recent use, for LRU eviction
+    std::error_code ec;
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    table    = std::move(table2);
+    keywords = std::move(keywords2);
+    numHits_++;
+    logger.debug("DFA cache: hit {}", path);
+    return true;
+}
+
+void DFAcache::store(const string &key, const DFAtable &table,
+                     const KeywordTable &keywords) {
+    Writer writer;
+    writer.put(string(MAGIC));
+    writer.put(DFA_CACHE_VERSION);
+    writer.put(key);
+    writer.put((int32_t) table.numStates);
+    writer.put((int32_t) table.numClasses);
+    writer.put(table.classMap);
+    writer.put(table.trans);
+    writer.put(table.finality);
+    writer.put(keywords.seed);
+    writer.put(keywords.ids);
+    writer.put(keywords.hosts);
+    writer.put((uint32_t) keywords.keys.size());
+    for (const string &k : keywords.keys) { writer.put(k); }
+    writer.put(vector<uint8_t>(keywords.isHost.begin(), keywords.isHost.end()));
+
+    // write aside then rename, readers never see a partial file
+    string path = getPath(key);
+    string temp = fmt::format("{}.{:x}.tmp", path, std::random_device()());
+    {
+        ofstream file(temp, ios::binary | ios::trunc);
+        file.write(writer.buf.data(), writer.buf.size());
+        if (!file) {
+            logger.warn("DFA cache: cannot write {}", temp);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(temp, path, ec);
+    if (ec) {
+        logger.warn("DFA cache: cannot write {}: {}", path, ec.message());
+        fs::remove(temp, ec);
+        return;
+    }
+    logger.debug("DFA cache: stored {} ({} bytes)", path, writer.buf.size());
+    evict();
+}
+
+// remove least recently used files until total size is within the cap
+void DFAcache::evict() {
+    struct Entry {
+        fs::file_time_type mtime;
+        uintmax_t          size;
+        fs::path           path;
+    };
+    vector<Entry>   entries;
+    uintmax_t       total = 0;
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(dir_, ec)) {
+        if (entry.path().extension() != ".dfa") { continue; }
+        uintmax_t size = entry.file_size(ec);
+        if (ec) { continue; }
+        entries.push_back({entry.last_write_time(ec), size, entry.path()});
+        total += size;
+    }
+    if (total <= maxBytes_) { return; }
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry &a, const Entry &b) { return a.mtime < b.mtime; });
+    for (const Entry &entry : entries) {
+        if (total <= maxBytes_) { break; }
+        if (fs::remove(entry.path, ec)) {
+            total -= entry.size;
+            numEvictions_++;
+            logger.debug("DFA cache: evicted {}", entry.path.string());
+        }
+    }
+}
+
+void DFAcache::clear() {
+    std::error_code ec;
+    for (const auto &entry : fs::directory_iterator(dir_, ec)) {
+        if (entry.path().extension() == ".dfa") { fs::remove(entry, ec); }
+    }
+}
+
+static std::unique_ptr<DFAcache> &defaultCache() {
+    static std::unique_ptr<DFAcache> cache = []() {
+        const char *dir = std::getenv("KRILL_CACHE_DIR");
+        return (dir != nullptr && *dir != '\0')
+                   ? std::make_unique<DFAcache>(dir)
+                   : nullptr;
+    }();
+    return cache;
+}
+
+DFAcache *getDefaultCache() { return defaultCache().get(); }
+
+void setDefaultCache(string dir, uintmax_t maxBytes) {
+    defaultCache() = dir.empty() ? nullptr
+                                 : std::make_unique<DFAcache>(dir, maxBytes);
+}
+
+} // namespace krill::cache
@@ -1,14 +1,16 @@
 #include "krill/codegen.h"
 #include "krill/automata.h"
 #include "krill/grammar.h"
+#include "krill/lexical.h"
 #include "krill/regex.h"
 #include "krill/utils.h"
 #include <fmt/format.h>
 #include <sstream>
 using namespace krill::type;
 using namespace krill::regex;
-using krill::automata::getDFAintegrated;
+using krill::automata::getDFAintegrated, krill::automata::getDFAtable;
 using krill::grammar::getLALR1table;
+using krill::runtime::getDFAtableWithKeywords;
 using namespace krill::utils;
 using namespace std;
 
@@ -174,6 +176,68 @@ void genDFA(const DFA &dfa, ostream &oss) {
         def_finality.str());
 }
 
+void genDFAtable(const DFAtable &table, ostream &oss) {
+    stringstream def_classMap;
+    def_classMap << "{";
+    for (int byte = 0; byte < 256; byte++) {
+        def_classMap << (byte % 32 == 0 ? "\n  " : "");
+        def_classMap << (int) table.classMap[byte] << ",";
+    }
+    def_classMap << "\n}";
+
+    stringstream def_trans;
+    def_trans << "{\n";
+    for (int state = 0; state < table.numStates; state++) {
+        auto st = table.trans.begin() + state * table.numClasses;
+        def_trans << fmt::format("  /* {:3d} */ {},\n", state,
+                                 fmt::join(st, st + table.numClasses, ","));
+    }
+    def_trans << "}";
+
+    stringstream def_finality;
+    def_finality << fmt::format("{{\n  {}\n}}",
+                                fmt::join(table.finality, ","));
+
+    oss << "struct DFAtable {\n"
+           "  int numStates; int numClasses;\n"
+           "  vector<uint8_t> classMap; vector<int32_t> trans;\n"
+           "  vector<int32_t> finality;\n"
+           "};\n";
+    oss << fmt::format("// states={}, classes={}\n", table.numStates,
+                       table.numClasses);
+    oss << fmt::format("const vector<uint8_t> classMap = {};\n\n",
+                       def_classMap.str());
+    oss << fmt::format("const vector<int32_t> trans = {};\n\n",
+                       def_trans.str());
+    oss << fmt::format("const vector<int32_t> finality = {};\n\n",
+                       def_finality.str());
+    oss << fmt::format("const DFAtable dfaTable({{.numStates = {}, "
+                       ".numClasses = {}, .classMap = classMap, "
+                       ".trans = trans, .finality = finality}});\n",
+                       table.numStates, table.numClasses);
+}
+
+void genKeywordTable(const KeywordTable &keywords, ostream &oss) {
+    stringstream def_keys;
+    def_keys << "{";
+    for (const string &key : keywords.keys) {
+        def_keys << fmt::format("\"{}\",", key);
+    }
+    def_keys << "}";
+
+    oss << "struct KeywordTable {\n"
+           "  uint32_t seed;\n"
+           "  vector<int> ids; vector<int> hosts;\n"
+           "  vector<string> keys; vector<bool> isHost;\n"
+           "};\n";
+    oss << fmt::format("const KeywordTable keywordTable({{.seed = {}, "
+                       ".ids = {{{}}}, .hosts = {{{}}}, .keys = {}, "
+                       ".isHost = {{{}}}}});\n",
+                       keywords.seed, fmt::join(keywords.ids, ","),
+                       fmt::join(keywords.hosts, ","), def_keys.str(),
+                       fmt::join(keywords.isHost, ","));
+}
+
 void genSyntaxParser(const Grammar &grammar, ostream &oss) {
     auto actionTable = getLALR1table(grammar);
 
@@ -188,18 +252,18 @@ void genSyntaxParser(const Grammar &grammar, ostream &oss) {
 }
 
 void genLexicalParser(const vector<string> &regexs, ostream &oss) {
-    vector<DFA> dfas;
-    for (string regex : regexs) { dfas.push_back(getDFAfromRegex(regex)); }
-    DFA dfai = getDFAintegrated(dfas);
+    auto[table, keywords] = getDFAtableWithKeywords(regexs);
 
     for (int i = 0; i < regexs.size(); i++) {
         oss << fmt::format("// {:2d}: {}\n", i, regexs[i]);
     }
     oss << "\n";
 
-    genDFA(dfai, oss);
+    genDFAtable(table, oss);
+    oss << "\n";
+    genKeywordTable(keywords, oss);
     oss << "\n";
-    oss << "LexicalParser lexicalParser(dfa);\n\n";
+    oss << "LexicalParser lexicalParser(dfaTable, keywordTable);\n\n";
 
     stringstream def_func;
     def_func << "  switch (token.id) {\n";
@@ -213,4 +277,135 @@ void genLexicalParser(const vector<string> &regexs, ostream &oss) {
                        def_func.str());
 }
 
+// direct-coded (goto-based) scanner: one label per state, switch on the
+// class of byte, accept actions inlined; no dependency on krill
+void genDFAdirect(const DFAtable &table, const KeywordTable &keywords,
+                  ostream &oss) {
+    stringstream def_classMap;
+    def_classMap << "{";
+    for (int byte = 0; byte < 256; byte++) {
+        def_classMap << (byte % 32 == 0 ? "\n    " : "");
+        def_classMap << (int) table.classMap[byte] << ",";
+    }
+    def_classMap << "\n  }";
+
+    // states with incoming edges need a label
+    vector<bool> isTarget(table.numStates, false);
+    for (int next : table.trans) {
+        if (next >= 0) { isTarget[next] = true; }
+    }
+
+    stringstream def_states;
+    for (int state = 0; state < table.numStates; state++) {
+        if (isTarget[state]) { def_states << fmt::format("s{}:\n", state); }
+
+        // classes with the same target share a case
+        map<int, vector<int>> targetClasses;
+        for (int cls = 0; cls < table.numClasses; cls++) {
+            int next = table.trans[state * table.numClasses + cls];
+            if (next >= 0) { targetClasses[next].push_back(cls); }
+        }
+        if (targetClasses.size() > 0) {
+            def_states << "  if (p < ed) {\n"
+                          "    switch (classMap[*p]) {\n";
+            for (const auto &[next, classes] : targetClasses) {
+                def_states << "    ";
+                for (int cls : classes) {
+                    def_states << fmt::format("case {}: ", cls);
+                }
+                def_states << fmt::format("p++; goto s{};\n", next);
+            }
+            def_states << "    }\n"
+                          "  }\n";
+        }
+
+        // cannot continue, accept token if final
+        if (table.finality[state] == 0) {
+            def_states << "  return -2;\n";
+        } else if (table.finality[state] - 1 < keywords.isHost.size() &&
+                   keywords.isHost[table.finality[state] - 1]) {
+            def_states << fmt::format(
+                "  offset = p - (const unsigned char *) input;\n"
+                "  return lexicalKeyword(st, p, {});\n",
+                table.finality[state] - 1);
+        } else {
+            def_states << fmt::format(
+                "  offset = p - (const unsigned char *) input;\n"
+                "  return {};\n",
+                table.finality[state] - 1);
+        }
+    }
+
+    // keywords split off, picked out of lexemes of host rules
+    if (keywords.ids.size() > 0) {
+        vector<string> def_keys;
+        vector<size_t> lens;
+        for (const string &key : keywords.keys) {
+            def_keys.push_back(fmt::format("\"{}\"", key));
+            lens.push_back(key.size());
+        }
+        oss << "// keywords split off the DFA, by perfect hash on length, "
+               "first and last byte\n";
+        oss << "static int lexicalKeyword(const unsigned char *st, "
+               "const unsigned char *ed, int id) {\n";
+        oss << fmt::format("  static const char *const keys[{}] = {{{}}};\n",
+                           def_keys.size(), fmt::join(def_keys, ","));
+        oss << fmt::format("  static const size_t lens[{}] = {{{}}};\n",
+                           lens.size(), fmt::join(lens, ","));
+        oss << fmt::format("  static const int ids[{}] = {{{}}};\n",
+                           keywords.ids.size(), fmt::join(keywords.ids, ","));
+        oss << fmt::format("  static const int hosts[{}] = {{{}}};\n\n",
+                           keywords.hosts.size(),
+                           fmt::join(keywords.hosts, ","));
+        oss << fmt::format("  uint32_t h = ({}u ^ (uint32_t) (ed - st)) * "
+                           "16777619u;\n",
+                           keywords.seed);
+        oss << "  h = (h ^ st[0]) * 16777619u;\n"
+               "  h = (h ^ ed[-1]) * 16777619u;\n";
+        oss << fmt::format("  h = (h ^ (h >> 15)) & {};\n",
+                           keywords.ids.size() - 1);
+        oss << "  if (hosts[h] == id && lens[h] == (size_t) (ed - st) &&\n"
+               "      memcmp(keys[h], st, lens[h]) == 0) {\n"
+               "    return ids[h];\n"
+               "  }\n"
+               "  return id;\n"
+               "}\n\n";
+    }
+
+    oss << fmt::format("// states={}, classes={}\n", table.numStates,
+                       table.numClasses);
+    oss << "// read one token from input[offset, size), offset moves to its "
+           "end\n"
+           "// return lexical id, -1 at the end of input, -2 if unmatched "
+           "(offset unchanged)\n";
+    oss << "int lexicalParseStep(const char *input, size_t size, size_t "
+           "&offset) {\n";
+    oss << fmt::format("  static const uint8_t classMap[256] = {};\n\n",
+                       def_classMap.str());
+    oss << "  const unsigned char *p  = (const unsigned char *) input + "
+           "offset;\n"
+           "  const unsigned char *ed = (const unsigned char *) input + "
+           "size;\n";
+    if (keywords.ids.size() > 0) {
+        oss << "  const unsigned char *st = p;\n";
+    }
+    oss << "  if (p == ed) { return -1; }\n\n";
+    oss << def_states.str();
+    oss << "}\n";
+}
+
+void genLexicalParserDirect(const vector<string> &regexs, ostream &oss) {
+    auto[table, keywords] = getDFAtableWithKeywords(regexs);
+
+    for (int i = 0; i < regexs.size(); i++) {
+        oss << fmt::format("// {:2d}: {}\n", i, regexs[i]);
+    }
+    oss << "\n";
+    oss << "#include <cstddef>\n"
+           "#include <cstdint>\n"
+           "#include <cstring>\n"
+           "\n";
+    genDFAdirect(table, keywords, oss);
+}
+
 } // namespace krill::codegen
\ No newline at end of file
@@ -5,10 +5,13 @@
 #include "spdlog/spdlog.h"
 #include <algorithm>
 #include <cassert>
+#include <climits>
+#include <functional>
 #include <iostream>
 #include <queue>
 #include <sstream>
 #include <tuple>
+#include <unordered_map>
 using namespace krill::utils;
 using krill::log::logger;
 using std::min, std::max;
@@ -247,12 +250,28 @@ ActionTable getLR1table(Grammar grammar) {
 
 // LALR(1) action table
 ActionTable getLALR1table(Grammar grammar) {
-    auto lr1Automata   = getLR1automata(grammar);
-    auto lalr1Automata = getLALR1fromLR1(grammar, lr1Automata);
+    auto lalr1Automata = getLALR1automata(grammar);
     auto lalr1table    = getLR1table(grammar, lalr1Automata);
     return lalr1table;
 }
 
+size_t LR1StateHash::operator()(const LR1State &state) const {
+    size_t h = state.size();
+    for (const auto &[core, searches] : state) {
+        h = (h * 1000003u ^ core.pidx) * 1000003u ^ core.dot;
+        for (uint64_t word : searches.words) { h = h * 1000003u ^ word; }
+    }
+    return h;
+}
+
+bool ProdItem::operator<(const ProdItem &p) const {
+    return std::tie(pidx, dot) < std::tie(p.pidx, p.dot);
+}
+
+bool ProdItem::operator==(const ProdItem &p) const {
+    return std::tie(pidx, dot) == std::tie(p.pidx, p.dot);
+}
+
 bool ProdLR1Item::operator<(const ProdLR1Item &p) const {
     return std::tie(pidx, dot, search) < std::tie(p.pidx, p.dot, p.search);
 }
@@ -261,59 +280,97 @@ bool ProdLR1Item::operator==(const ProdLR1Item &p) const {
     return std::tie(pidx, dot, search) == std::tie(p.pidx, p.dot, p.search);
 }
 
-map<int, set<int>> getFirstSets(Grammar grammar) {
-    map<int, set<int>> firstSets;
-    // first(a) = {a}
-    for (int c : grammar.terminalSet) { firstSets[c] = {c}; }
-    // first(A) = {}
-    for (int symbol : grammar.nonterminalSet) { firstSets[symbol] = {}; }
-
-    for (Prod prod : grammar.prods) {
-        // prod: X -> ...
-        if (prod.right.size() > 0 && grammar.terminalSet.count(prod.right[0])) {
-            // X -> a... ==> first(X) += {a}
-            firstSets[prod.symbol].insert(prod.right[0]);
-        } else if (prod.right.size() == 0) {
-            // X -> epsilon ==> first(X) += {epsilon}
-            firstSets[prod.symbol].insert(EMPTY_SYMBOL);
-        }
+bool Bitset::merge(const Bitset &b) {
+    uint64_t changed = 0;
+    for (int w = 0; w < words.size(); w++) {
+        changed |= b.words[w] & ~words[w];
+        words[w] |= b.words[w];
     }
+    return changed != 0;
+}
 
-    while (true) {
-        bool isChanged = false;
-        for (Prod prod : grammar.prods) {
-            // prod: X -> ... (not empty)
-            if (prod.right.size() == 0) { continue; }
-            for (int i = 0; i < prod.right.size(); i++) {
-                // prod: X -> Y0 Y1...Yi γ, epsilon ∈ first(Y0),...,first(Yi)
-                // ==> first(X) += first(γ)
-                int      y       = prod.right[i];
-                set<int> tempSet = firstSets[y];
-                tempSet.erase(EMPTY_SYMBOL);
-                for (int elem : tempSet) {
-                    if (firstSets[prod.symbol].count(elem) == 0) {
-                        isChanged = true;
-                        firstSets[prod.symbol].insert(elem);
-                    }
-                }
+bool Bitset::empty() const {
+    for (uint64_t word : words) {
+        if (word != 0) { return false; }
+    }
+    return true;
+}
+
+// terminals by dense id: END_SYMBOL, then terminals ascending
+static vector<int> getDenseTerminals(const Grammar &grammar) {
+    vector<int> terminals({END_SYMBOL});
+    terminals.insert(terminals.end(), grammar.terminalSet.begin(),
+                     grammar.terminalSet.end());
+    return terminals;
+}
 
-                if (firstSets[y].count(EMPTY_SYMBOL) == 0) {
+GrammarIndex::GrammarIndex(const Grammar &grammar) {
+    // dense ids
+    symbols      = getDenseTerminals(grammar);
+    numTerminals = symbols.size();
+    for (int symbol : grammar.nonterminalSet) { symbols.push_back(symbol); }
+    for (int id = 0; id < symbols.size(); id++) { ids[symbols[id]] = id; }
+
+    prodsOf.resize(symbols.size());
+    for (int pidx = 0; pidx < grammar.prods.size(); pidx++) {
+        const Prod &prod = grammar.prods[pidx];
+        prodsOf[ids.at(prod.symbol)].push_back(pidx);
+        rights.emplace_back();
+        for (int symbol : prod.right) { rights.back().push_back(ids.at(symbol)); }
+    }
+
+    // nullable and FIRST, until nothing changes
+    // first(a) = {a}
+    isNullable.assign(symbols.size(), false);
+    firstSets.assign(symbols.size(), Bitset(numTerminals));
+    for (int id = 0; id < numTerminals; id++) { firstSets[id].insert(id); }
+    for (bool isChanged = true; isChanged;) {
+        isChanged = false;
+        for (int pidx = 0; pidx < rights.size(); pidx++) {
+            // X -> Y0 Y1...Yi γ, ε ∈ first(Y0),...,first(Yi-1)
+            // ==> first(X) += first(Yi) - {ε}
+            int  x          = ids.at(grammar.prods[pidx].symbol);
+            bool isAllEmpty = true;
+            for (int y : rights[pidx]) {
+                isChanged |= firstSets[x].merge(firstSets[y]);
+                if (!isNullable[y]) {
+                    isAllEmpty = false;
                     break;
-                } else {
-                    // prod: X -> Y0 Y1...Yi, epsilon ∈ first(Y0),...,first(Yi)
-                    // ==> first(X) += {epsilon}
-                    if (i == prod.right.size() - 1) {
-                        if (firstSets[prod.symbol].count(EMPTY_SYMBOL) == 0) {
-                            isChanged = true;
-                            firstSets[prod.symbol].insert(EMPTY_SYMBOL);
-                        }
-                    }
                 }
             }
+            if (isAllEmpty && !isNullable[x]) {
+                isNullable[x] = isChanged = true;
+            }
         }
-        if (isChanged == false) { break; }
     }
 
+    // first(Yi...Yn) = first(Yi) + (first(Yi+1...Yn) if Yi nullable)
+    for (const vector<int> &right : rights) {
+        suffixFirstSets.emplace_back(right.size() + 1, Bitset(numTerminals));
+        isSuffixNullable.emplace_back(right.size() + 1, true);
+        auto &suffixFirst    = suffixFirstSets.back();
+        auto &suffixNullable = isSuffixNullable.back();
+        for (int dot = (int) right.size() - 1; dot >= 0; dot--) {
+            suffixFirst[dot] = firstSets[right[dot]];
+            if (isNullable[right[dot]]) {
+                suffixFirst[dot].merge(suffixFirst[dot + 1]);
+            }
+            suffixNullable[dot] =
+                isNullable[right[dot]] && suffixNullable[dot + 1];
+        }
+    }
+}
+
+map<int, set<int>> getFirstSets(Grammar grammar) {
+    GrammarIndex       index(grammar);
+    map<int, set<int>> firstSets;
+    // END_SYMBOL not included
+    for (int id = 1; id < index.symbols.size(); id++) {
+        set<int> &firstSet = firstSets[index.symbols[id]];
+        index.firstSets[id].forEach(
+            [&](int t) { firstSet.insert(index.symbols[t]); });
+        if (index.isNullable[id]) { firstSet.insert(EMPTY_SYMBOL); }
+    }
     return firstSets;
 }
 
@@ -373,126 +430,120 @@ map<int, set<int>> getFollowSets(Grammar            grammar,
 // main part of lr(1) algorithm
 LR1Automata getLR1automata(Grammar grammar) {
     logger.info("begin generating LR1 Automata");
-    auto firstSets  = getFirstSets(grammar);
-    auto followSets = getFollowSets(grammar, firstSets); // unused 
-    logger.trace("first-sets: \n{}", to_string(firstSets, grammar));
-    logger.trace("follow-sets: \n{}", to_string(followSets, grammar));
-
-    // cache, really speed it up
-    map<LR1State, LR1State> cache;
-    auto                    closured = [&](LR1State &state) {
-        if (cache.count(state) == 0) {
-            cache[state] = getLR1StateExpanded(state, firstSets, grammar);
-        }
-        state = cache.at(state);
-    };
+    GrammarIndex index(grammar);
+    if (logger.should_log(spdlog::level::trace)) {
+        logger.trace("first-sets: \n{}",
+                     to_string(getFirstSets(grammar), grammar));
+    }
 
     // generate states
     vector<LR1State> states;
-    LR1State         initStates = {{0, 0, END_SYMBOL}};
-    initStates = getLR1StateExpanded(initStates, firstSets, grammar);
+    LR1State         initStates = {{{0, 0}, Bitset(index.numTerminals)}};
+    initStates.at({0, 0}).insert(index.ids.at(END_SYMBOL));
+    std::unordered_map<LR1State, int, LR1StateHash> kernelIdx;
+    kernelIdx[initStates] = 0;
+    initStates = getLR1StateExpanded(initStates, index);
     states.push_back(initStates); // generate inital state
 
     const auto &prods = grammar.prods;
 
-    // bfs, generate follow states
-    EdgeTable edgeTable;
-    for (int i = 0; i < states.size(); i++) {
-        logger.debug("  bfs visit lr1 state {} / {}", i, states.size());
-        map<int, LR1State> nextStatess;
-        for (const ProdLR1Item &item : states[i]) {
-            const Prod &prod = prods[item.pidx];
-            // current state: (A -> α·Bβ, s)
-            // B => next state: (A -> αB·β, s)
-            if (item.dot < prod.right.size()) {
-                int c = prod.right[item.dot];
-                if (nextStatess.count(c) == 0) { nextStatess[c] = {}; }
-                nextStatess[c].insert({item.pidx, item.dot + 1, item.search});
-            }
-        }
-        // CLOSURE, cost time!
-        for (auto & [ symbol, nextStates ] : nextStatess) {
-            closured(nextStates);
+    // states identified by kernel (items before closure): closure adds only
+    // items of dot 0, which no kernel but the initial one has
+
+    // bfs by layer: gotos and closures of a layer are computed on
+    // parallel_threads() threads, while new kernels are interned in
+    // (state, symbol) order, so state ids and edges are the same as a
+    // sequential bfs, whatever the number of threads
+    auto forLayer = [](size_t n, auto func) {
+        if (n < 16) { // not worth the threads
+            for (size_t k = 0; k < n; k++) { func(k); }
+        } else {
+            krill::utils::parallel_for(n, func);
         }
-        // add new states
-        for (const auto & [ symbol, nextStates ] : nextStatess) {
-            int tgtIdx;
-            for (tgtIdx = 0; tgtIdx < states.size(); tgtIdx++) {
-                if (nextStates == states[tgtIdx]) { break; }
+    };
+    EdgeTable                  edgeTable;
+    vector<map<int, LR1State>> nextKernels;
+    vector<const LR1State *>   newKernels;
+    for (int lo = 0, hi; lo < states.size(); lo = hi) {
+        hi = states.size();
+        logger.debug("  bfs visit lr1 states {}..{} / {}", lo, hi - 1, hi);
+        nextKernels.assign(hi - lo, {});
+        forLayer(hi - lo, [&](size_t k) {
+            for (const auto &[core, searches] : states[lo + k]) {
+                const Prod &prod = prods[core.pidx];
+                // current state: (A -> α·Bβ, s)
+                // B => next state: (A -> αB·β, s)
+                if (core.dot < prod.right.size()) {
+                    auto &kernel = nextKernels[k][prod.right[core.dot]];
+                    kernel.emplace_hint(kernel.end(),
+                                        ProdItem{core.pidx, core.dot + 1},
+                                        searches);
+                }
             }
-            if (tgtIdx == states.size()) { states.push_back(nextStates); }
+        });
 
-            edgeTable.push_back({symbol, i, tgtIdx});
+        newKernels.clear();
+        for (int i = lo; i < hi; i++) {
+            for (auto &[symbol, kernel] : nextKernels[i - lo]) {
+                auto [it, isNew] = kernelIdx.emplace(std::move(kernel),
+                                                     states.size());
+                if (isNew) {
+                    newKernels.push_back(&it->first); // nodes never move
+                    states.emplace_back();
+                }
+                edgeTable.push_back({symbol, i, it->second});
+            }
         }
+
+        // CLOSURE (cost time!) only for new kernels
+        forLayer(newKernels.size(), [&](size_t k) {
+            states[hi + k] = getLR1StateExpanded(*newKernels[k], index);
+        });
     }
 
-    LR1Automata lr1Automata({states, edgeTable});
+    vector<int> terminals(index.symbols.begin(),
+                          index.symbols.begin() + index.numTerminals);
+    LR1Automata lr1Automata({states, edgeTable, terminals});
     logger.info(
         "complete generating LR1 Automata (num_states={}, num_edges={})",
         states.size(), edgeTable.size());
-    logger.trace("LR1 Automata: \n{}", to_string(lr1Automata, grammar));
+    if (logger.should_log(spdlog::level::trace)) {
+        logger.trace("LR1 Automata: \n{}", to_string(lr1Automata, grammar));
+    }
     return lr1Automata;
 }
 
 // expand the LR(1) state (epsilon-closure method)
-LR1State getLR1StateExpanded(const LR1State &state, const map<int, set<int>> &firstSets,
-                         const Grammar &grammar) {
-    // given αβ...γ, return {c | c in first(αβ...γ) and c is terminals}
-    auto state_ = state;
-    const auto firstSets_ = firstSets;
-    const auto grammar_   = grammar;
-    auto       getSeqFirstSetTerminals =
-        [&grammar_, &firstSets_](const vector<int> &symbolSeq) -> set<int> {
-        set<int> seqFirstSet;
-        for (int s : symbolSeq) {
-            if (s == END_SYMBOL) {
-                seqFirstSet.insert(s);
-                break;
-            }
-            for (int t : firstSets_.at(s)) {
-                if (grammar_.terminalSet.count(t)) { seqFirstSet.insert(t); }
-            }
-            if (firstSets_.at(s).count(EMPTY_SYMBOL) == 0) { break; }
-        }
-        return seqFirstSet;
-    };
-
-    const auto &            prods = grammar.prods;
-    std::queue<ProdLR1Item> q;
-    for (ProdLR1Item item : state_) { q.push(item); }
-    while (q.size()) { // bfs
-        ProdLR1Item item = q.front();
-        q.pop();
-        const Prod &currProd = prods[item.pidx];
+// search symbols of a whole core item are propagated at once
+LR1State getLR1StateExpanded(const LR1State &state, const GrammarIndex &index) {
+    LR1State         state_ = state;
+    vector<ProdItem> stack;
+    for (const auto &[core, searches] : state_) { stack.push_back(core); }
+    while (stack.size()) { // dfs, again if search symbols grow
+        ProdItem core = stack.back();
+        stack.pop_back();
+        const vector<int> &right = index.rights[core.pidx];
 
         // (A -> α·, s) or (A -> α·aβ, s), no ε to expand
-        if (item.dot == currProd.right.size() ||
-            grammar.terminalSet.count(currProd.right[item.dot])) {
+        if (core.dot == right.size() || index.isTerminal(right[core.dot])) {
             continue;
         }
 
         // for item (A -> α·Bβ, s) in item-set I:
         //   for all production (B -> γ):
         //     state += (B -> ·γ, {c | c in first(βs) and c is terminals})
-        for (int p = 0; p < prods.size(); p++) {
-            const Prod &prod = prods[p];
-            if (prod.symbol != currProd.right[item.dot]) { continue; }
-            // nextSet = {c | c in first(βs) and c is terminals}
-            vector<int> afterSeq(currProd.right.begin() + item.dot + 1,
-                                 currProd.right.end());
-            afterSeq.push_back(item.search);
-            set<int> nextSet = getSeqFirstSetTerminals(afterSeq);
-            // state += (B -> ·γ, nextSet)
-            for (int c : nextSet) {
-                ProdLR1Item nextItem({p, 0, c});
-                if (state_.count(nextItem) == 0) {
-                    state_.insert(nextItem);
-                    q.push(nextItem);
-                }
+        Bitset nextSearches = index.suffixFirstSets[core.pidx][core.dot + 1];
+        if (index.isSuffixNullable[core.pidx][core.dot + 1]) {
+            nextSearches.merge(state_.at(core));
+        }
+        if (nextSearches.empty()) { continue; }
+        for (int p : index.prodsOf[right[core.dot]]) {
+            auto [it, isNew] = state_.try_emplace({p, 0}, nextSearches);
+            if (isNew || it->second.merge(nextSearches)) {
+                stack.push_back({p, 0});
             }
         }
     }
-
     return state_;
 }
 
@@ -515,8 +566,10 @@ ActionTable getLR1table(Grammar grammar, LR1Automata lr1Automata) {
             logger.critical(
                 "lr1 conflit at state s{}, search {}: ours: {}, theirs: {}",
                 symbolNames.at(search), ourAction.str(), theirAction.str());
-            logger.info("summary of state s{}: \n{}", from,
-                        to_string(states[from], grammar));
+            if (logger.should_log(spdlog::level::info)) {
+                logger.info("summary of state s{}: \n{}", from,
+                            to_string(states[from], grammar));
+            }
         }
         if (grammar.terminalSet.count(search)) {
             // s1 ——a-> s2 ==> action[s1, a] = s2
@@ -531,8 +584,16 @@ ActionTable getLR1table(Grammar grammar, LR1Automata lr1Automata) {
         }
     }
     // node ==> REDUCE and ACCEPT
+    const vector<int> &terminals = lr1Automata.terminals;
     for (int i = 0; i < states.size(); i++) {
-        for (ProdLR1Item item : states[i]) {
+        vector<ProdLR1Item> items; // (A -> α·, s)
+        for (const auto &[core, searches] : states[i]) {
+            if (core.dot != prods[core.pidx].right.size()) { continue; }
+            searches.forEach([&](int search) {
+                items.push_back({core.pidx, core.dot, terminals[search]});
+            });
+        }
+        for (ProdLR1Item item : items) {
             // s1: (S -> ...·, #) ==> action[s1, #] = ACCEPT
             // auto &symbol = prods[item.pidx].symbol; // unused
             auto &right = prods[item.pidx].right;
@@ -607,8 +668,10 @@ ActionTable getLR1table(Grammar grammar, LR1Automata lr1Automata) {
                         // resolved by default priority, dangerous!
                         logger.warn("  conflit resolved by default "
                                         "priority, may not be what you want");
-                        logger.info("  summary of state s{}: \n{}", i,
-                                    to_string(states[i], grammar));
+                        if (logger.should_log(spdlog::level::info)) {
+                            logger.info("  summary of state s{}: \n{}", i,
+                                        to_string(states[i], grammar));
+                        }
                     }
                 } else if (asso != Associate::kNone) {
                     // use ASSOCIATIVITY to resolve conflict
@@ -626,8 +689,10 @@ ActionTable getLR1table(Grammar grammar, LR1Automata lr1Automata) {
                         "failed to resolve by priority or associacity");
                     logger.warn("conflit resolved by FORCING reduce, may "
                                     "not be what you want");
-                    logger.info("summary of state s{}: \n{}", i,
-                                to_string(states[i], grammar));
+                    if (logger.should_log(spdlog::level::info)) {
+                        logger.info("summary of state s{}: \n{}", i,
+                                    to_string(states[i], grammar));
+                    }
                 }
             }
         }
@@ -659,8 +724,8 @@ LR1Automata getLALR1fromLR1(Grammar grammar, LR1Automata lr1Automata) {
 
     map<int, ID> stateIdx2ID; // <index LR1 states, concentric ID>
     for (int i = 0; i < states.size(); i++) {
-        for (auto item : states[i]) {
-            stateIdx2ID[i].insert(prodIndex.at({item.pidx, item.dot}));
+        for (const auto &[core, searches] : states[i]) {
+            stateIdx2ID[i].insert(prodIndex.at({core.pidx, core.dot}));
         }
     }
     map<ID, int> ID2LALRIdx;
@@ -686,7 +751,11 @@ LR1Automata getLALR1fromLR1(Grammar grammar, LR1Automata lr1Automata) {
     for (const auto & [ LALR1Idex, stateIdxs ] : LALRIdx2stateIdxs) {
         LR1State resState;
         for (int idx : stateIdxs) {
-            for (auto item : states[idx]) { resState.insert(item); }
+            // union of search symbols of the same core, at once
+            for (const auto &[core, searches] : states[idx]) {
+                auto [it, isNew] = resState.try_emplace(core, searches);
+                if (!isNew) { it->second.merge(searches); }
+            }
         }
         resStates.push_back(resState);
     }
@@ -696,12 +765,180 @@ LR1Automata getLALR1fromLR1(Grammar grammar, LR1Automata lr1Automata) {
     }
     for (auto edge : resEdgeTable0) { resEdgeTable.push_back(edge); }
 
-    LR1Automata lalr1Automata({resStates, resEdgeTable});
+    LR1Automata lalr1Automata(
+        {resStates, resEdgeTable, lr1Automata.terminals});
     logger.info("complete transferring LR1 Automata to LALR1 Automata "
                 "(num_states={} -> {}, num_edges={} -> {})",
                 states.size(), resStates.size(), edgeTable.size(),
                 resEdgeTable.size());
-    logger.trace("LALR1 Automata: \n{}", to_string(lalr1Automata, grammar));
+    if (logger.should_log(spdlog::level::trace)) {
+        logger.trace("LALR1 Automata: \n{}", to_string(lalr1Automata, grammar));
+    }
+    return lalr1Automata;
+}
+
+// digraph algorithm of DeRemer and Pennello:
+// F(x) = F'(x) ∪ {F(y) | x R y}, members of a cycle share the same F
+static vector<Bitset> getDigraphClosure(const vector<vector<int>> &relation,
+                                        vector<Bitset>             sets) {
+    vector<int>              depth(sets.size(), 0);
+    vector<int>              stack;
+    std::function<void(int)> traverse = [&](int x) {
+        stack.push_back(x);
+        int d    = stack.size();
+        depth[x] = d;
+        for (int y : relation[x]) {
+            if (depth[y] == 0) { traverse(y); }
+            depth[x] = min(depth[x], depth[y]);
+            sets[x].merge(sets[y]);
+        }
+        if (depth[x] == d) {
+            while (true) {
+                int y = stack.back();
+                stack.pop_back();
+                depth[y] = INT_MAX;
+                if (y == x) { break; }
+                sets[y] = sets[x];
+            }
+        }
+    };
+    for (int x = 0; x < sets.size(); x++) {
+        if (depth[x] == 0) { traverse(x); }
+    }
+    return sets;
+}
+
+// LALR(1) automata built directly, without LR(1) automata:
+// LR(0) automata, then lookaheads by DeRemer-Pennello relations
+// the same states and edges as getLALR1fromLR1(getLR1automata(...))
+LR1Automata getLALR1automata(Grammar grammar) {
+    logger.info("begin generating LALR1 Automata");
+    const auto  &prods = grammar.prods;
+    GrammarIndex index(grammar);
+    auto         idOf = [&index](int symbol) { return index.ids.at(symbol); };
+
+    // LR(0) automata, states in the same bfs order as getLR1automata
+    vector<vector<ProdItem>>   kernels({{{0, 0}}});
+    map<vector<ProdItem>, int> kernelIdx({{kernels[0], 0}});
+    vector<map<int, int>>      gotos; // {state, {symbol, next state}}
+    for (int i = 0; i < kernels.size(); i++) {
+        vector<ProdItem> items = kernels[i];
+        set<int>         expanded;
+        for (int k = 0; k < items.size(); k++) {
+            const Prod &prod = prods[items[k].pidx];
+            if (items[k].dot == prod.right.size()) { continue; }
+            int symbol = prod.right[items[k].dot];
+            if (expanded.insert(symbol).second) {
+                for (int p : index.prodsOf[idOf(symbol)]) {
+                    items.push_back({p, 0});
+                }
+            }
+        }
+        map<int, vector<ProdItem>> nextKernels;
+        for (const ProdItem &item : items) {
+            const Prod &prod = prods[item.pidx];
+            if (item.dot == prod.right.size()) { continue; }
+            nextKernels[prod.right[item.dot]].push_back({item.pidx,
+                                                         item.dot + 1});
+        }
+        map<int, int> nextStates;
+        for (auto &[symbol, kernel] : nextKernels) {
+            std::sort(kernel.begin(), kernel.end());
+            kernel.erase(std::unique(kernel.begin(), kernel.end()),
+                         kernel.end());
+            auto [it, isNew] = kernelIdx.emplace(kernel, kernels.size());
+            if (isNew) { kernels.push_back(kernel); }
+            nextStates[symbol] = it->second;
+        }
+        gotos.push_back(nextStates);
+    }
+
+    // nonterminal transitions (p, A), and a root one for (S -> ·..., ζ)
+    vector<pair<int, int>>   trans;
+    map<pair<int, int>, int> transIdx;
+    for (int i = 0; i < gotos.size(); i++) {
+        for (auto [symbol, next] : gotos[i]) {
+            if (!index.isTerminal(idOf(symbol))) {
+                transIdx[{i, symbol}] = trans.size();
+                trans.push_back({i, symbol});
+            }
+        }
+    }
+    int root = trans.size();
+
+    // DR(p, A) = {a | p -A-> r -a-> }
+    // (p, A) reads (r, C) if p -A-> r -C->, C nullable
+    vector<Bitset>      dr(root + 1, Bitset(index.numTerminals));
+    vector<vector<int>> reads(root + 1);
+    for (int t = 0; t < root; t++) {
+        int r = gotos[trans[t].first].at(trans[t].second);
+        for (auto [symbol, next] : gotos[r]) {
+            int id = idOf(symbol);
+            if (index.isTerminal(id)) {
+                dr[t].insert(id);
+            } else if (index.isNullable[id]) {
+                reads[t].push_back(transIdx.at({r, symbol}));
+            }
+        }
+    }
+    dr[root].insert(idOf(END_SYMBOL));
+    vector<Bitset> readSets = getDigraphClosure(reads, dr);
+
+    // walk (A -> ω) from p for each transition (p, A):
+    // (p', B) includes (p, A) if A -> βBγ, p -β-> p', γ nullable
+    auto walk = [&](int t, auto visit) {
+        int p = (t == root) ? 0 : trans[t].first;
+        for (int pidx : (t == root) ? vector<int>({0})
+                                    : index.prodsOf[idOf(trans[t].second)]) {
+            const vector<int> &right = prods[pidx].right;
+            int                state = p;
+            for (int dot = 0; dot <= right.size(); dot++) {
+                visit(state, pidx, dot);
+                if (dot < right.size()) {
+                    state = gotos[state].at(right[dot]);
+                }
+            }
+        }
+    };
+    vector<vector<int>> includes(root + 1);
+    for (int t = 0; t <= root; t++) {
+        walk(t, [&](int state, int pidx, int dot) {
+            const vector<int> &right = prods[pidx].right;
+            if (dot == right.size() || index.isTerminal(idOf(right[dot]))) {
+                return;
+            }
+            if (index.isSuffixNullable[pidx][dot + 1]) {
+                includes[transIdx.at({state, right[dot]})].push_back(t);
+            }
+        });
+    }
+    vector<Bitset> followSets = getDigraphClosure(includes, readSets);
+
+    // LA(q, A -> α·β) = ∪{Follow(p, A) | p -α-> q}
+    vector<LR1State> states(kernels.size());
+    for (int t = 0; t <= root; t++) {
+        if (followSets[t].empty()) { continue; }
+        walk(t, [&](int state, int pidx, int dot) {
+            auto [it, isNew] =
+                states[state].try_emplace({pidx, dot}, followSets[t]);
+            if (!isNew) { it->second.merge(followSets[t]); }
+        });
+    }
+    set<Edge> edges;
+    for (int i = 0; i < gotos.size(); i++) {
+        for (auto [symbol, next] : gotos[i]) { edges.insert({symbol, i, next}); }
+    }
+
+    vector<int> terminals(index.symbols.begin(),
+                          index.symbols.begin() + index.numTerminals);
+    LR1Automata lalr1Automata(
+        {states, EdgeTable(edges.begin(), edges.end()), terminals});
+    logger.info(
+        "complete generating LALR1 Automata (num_states={}, num_edges={})",
+        states.size(), edges.size());
+    if (logger.should_log(spdlog::level::trace)) {
+        logger.trace("LALR1 Automata: \n{}", to_string(lalr1Automata, grammar));
+    }
     return lalr1Automata;
 }
 
@@ -749,16 +986,15 @@ string to_string(const ProdLR1Item &item, const Grammar &grammar) {
 }
 
 string to_string(const LR1State &state, const Grammar &grammar) {
+    vector<int>  terminals = getDenseTerminals(grammar);
     stringstream ss;
-    for (auto it = state.begin(); it != state.end();) {
-        ss << "  " << to_string(*it, grammar);
-        for (auto it_prev = it++;
-             it != state.end() && std::tie(it->pidx, it->dot) ==
-                                      std::tie(it_prev->pidx, it_prev->dot);
-             it++) {
-            ss << " " << grammar.symbolNames.at(it->search);
-        }
-        ss << "\n";
+    for (const auto &[core, searches] : state) {
+        vector<string> names;
+        searches.forEach([&](int search) {
+            names.push_back(grammar.symbolNames.at(terminals[search]));
+        });
+        ss << "  " << to_string(core, grammar)
+           << fmt::format("  ⎥⎥ {}\n", fmt::join(names, " "));
     }
     return ss.str();
 }
@@ -1,19 +1,35 @@
 #include "fmt/format.h"
 #include "krill/lexical.h"
 #include "krill/automata.h"
+#include "krill/cache.h"
 #include "krill/regex.h"
 #include "krill/utils.h"
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <set>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 using krill::log::logger;
-using krill::error::parse_error;
+using krill::error::parse_error, krill::error::state_budget_error;
 using namespace krill::type;
 using namespace std;
-using krill::automata::getDFAintegrated;
-using krill::regex::getDFAfromRegex;
+using krill::automata::getDFAintegrated, krill::automata::getDFAtable;
+using krill::automata::getDFAaccels, krill::automata::getNFAintegrated;
+using krill::automata::getMinimizedDfa, krill::automata::getReachableDfa;
+using krill::automata::getClosureMapfromNFAgraph;
+using krill::cache::DFAcache, krill::cache::getDefaultCache;
+using krill::regex::getDFAfromRegex, krill::regex::RegexCompiler;
 using krill::utils::unescape;
 
 
@@ -37,18 +53,308 @@ bool Token::operator!=(const Token &t) const {
 
 namespace krill::runtime {
 
-LexicalParser::LexicalParser(DFA dfai) : dfa_(dfai), state_(0) {}
+// compile regexs independently, in parallel, each within maxRuleStates
+// rules beyond it are left out into vmRules (sorted)
+static void compileRules(const vector<string> &regexs, vector<DFA> &dfas,
+                         vector<int> &vmRules) {
+    dfas.assign(regexs.size(), DFA());
+    // not vector<bool>, whose slots share words across threads
+    vector<char> isOver(regexs.size(), false);
+    krill::utils::parallel_for(regexs.size(), [&](size_t i) {
+        try {
+            dfas[i] = getDFAfromRegex(regexs[i], RegexCompiler::kFollowpos,
+                                      maxRuleStates);
+        } catch (const state_budget_error &) { isOver[i] = true; }
+    });
+    vmRules.clear();
+    for (int i = 0; i < regexs.size(); i++) {
+        if (isOver[i]) { vmRules.push_back(i); }
+    }
+}
+
+LexicalParser::LexicalParser(DFA dfai, KeywordTable keywords)
+    : dfa_(dfai), table_(getDFAtable(dfa_)), keywords_(keywords),
+      accels_(getDFAaccels(table_)), state_(0) {}
+
+LexicalParser::LexicalParser(DFAtable table, KeywordTable keywords)
+    : table_(table), keywords_(keywords), accels_(getDFAaccels(table_)),
+      state_(0) {}
 
 LexicalParser::LexicalParser(vector<DFA> dfas)
-    : dfa_(getDFAintegrated(dfas)), state_(0) {}
+    : dfa_(getDFAintegrated(dfas)), table_(getDFAtable(dfa_)),
+      accels_(getDFAaccels(table_)), state_(0) {}
 
 LexicalParser::LexicalParser(vector<string> regexs) {
     state_ = 0;
+    vector<int> vmRules;
+    std::tie(table_, keywords_) = getDFAtableWithKeywords(regexs, &vmRules);
+    accels_ = getDFAaccels(table_);
+    setVMs(regexs, vmRules);
+}
+
+LexicalParser::LexicalParser(vector<string> regexs, bool lazy) {
+    if (!lazy) {
+        *this = LexicalParser(regexs);
+        return;
+    }
+    // only the small per-rule DFAs are built up front
+    vector<DFA> dfas;
+    vector<int> vmRules;
+    compileRules(regexs, dfas, vmRules);
+    vector<DFA> subDfas;
+    for (int i = 0; i < regexs.size(); i++) {
+        if (std::binary_search(vmRules.begin(), vmRules.end(), i)) {
+            continue;
+        }
+        for (auto &[state, finality] : dfas[i].finality) {
+            if (finality != 0) { finality = i + 1; }
+        }
+        subDfas.push_back(std::move(dfas[i]));
+    }
+    *this = LexicalParser(LazyDFA(getNFAintegrated(subDfas)));
+    setVMs(regexs, vmRules);
+}
+
+LexicalParser::LexicalParser(LazyDFA lazy)
+    : accelerated_(false), state_(0), lazy_(std::move(lazy)) {}
+
+// the rule winning on the whole src, -1 if not accepted
+static int getWinner(const DFA &dfa, const string &src) {
+    int state = 0;
+    for (char c : src) {
+        auto it = dfa.graph.find(state);
+        if (it == dfa.graph.end() || it->second.count(c) == 0) { return -1; }
+        state = it->second.at(c);
+    }
+    auto it = dfa.finality.find(state);
+    return (it == dfa.finality.end()) ? -1 : it->second - 1;
+}
+
+// integrated DFA of the rules, finality keeps the original lexical ids
+static DFA getDFAofRules(const vector<DFA> &dfas, const vector<int> &rules) {
+    vector<DFA> subDfas;
+    for (int i : rules) { subDfas.push_back(dfas[i]); }
+    DFA dfa = getDFAintegrated(subDfas);
+    for (auto &[state, f] : dfa.finality) {
+        if (f != 0) { f = rules[f - 1] + 1; }
+    }
+    return dfa;
+}
+
+pair<DFA, KeywordTable> getDFAwithKeywords(const vector<string> &regexs,
+                                           vector<int> *vmRules) {
     vector<DFA> dfas;
-    for (string regex : regexs) { dfas.push_back(getDFAfromRegex(regex)); }
-    dfa_ = getDFAintegrated(dfas);
+    vector<int> overRules;
+    compileRules(regexs, dfas, overRules);
+    if (vmRules != nullptr) {
+        *vmRules = overRules;
+    } else if (overRules.size() > 0) {
+        int i = overRules.front();
+        throw runtime_error(fmt::format(
+            "lexical rule {} ‘{}’: DFA goes beyond {} states", i,
+            unescape(regexs[i]), maxRuleStates));
+    }
+
+    // literal keyword candidates: [a-zA-Z0-9_]+
+    vector<int> candidates, others;
+    for (int i = 0; i < regexs.size(); i++) {
+        if (std::binary_search(overRules.begin(), overRules.end(), i)) {
+            continue;
+        }
+        bool isLiteral = regexs[i].size() > 0;
+        for (char c : regexs[i]) { isLiteral &= (isalnum((unsigned char) c) || c == '_'); }
+        (isLiteral ? candidates : others).push_back(i);
+    }
+
+    // split off a keyword if a later rule wins it without keywords in DFA,
+    // then the stuck state is unchanged for any input, and the keyword
+    // can be picked out from lexemes of that (host) rule
+    // keywords not distinguishable by the hash (same length, first and last
+    // byte) are kept in DFA
+    map<string, pair<int, int>>    keywords; // {keyword, {id, host}}
+    set<tuple<size_t, char, char>> hashKeys;
+    vector<int>                    rules = others;
+    if (candidates.size() > 0) {
+        DFA dfa = getDFAofRules(dfas, others);
+        for (int i : candidates) {
+            const string &key     = regexs[i];
+            int           host    = getWinner(dfa, key);
+            auto          hashKey = make_tuple(key.size(), key.front(), key.back());
+            if (host > i && keywords.count(key) != 0) {
+                continue; // duplicated, never recognized
+            } else if (host > i && hashKeys.count(hashKey) == 0 &&
+                       std::none_of(overRules.begin(), overRules.end(),
+                                    [&](int j) { return i < j && j < host; })) {
+                // (a GlushkovVM rule between them may win it instead of host)
+                keywords[key] = {i, host};
+                hashKeys.insert(hashKey);
+            } else {
+                rules.push_back(i);
+            }
+        }
+    }
+
+    // perfect hash: search a seed with no collision in the slots, slots
+    // needed grow as square of keywords (birthday bound), give up at a
+    // limit and keep keywords in DFA instead
+    KeywordTable table;
+    size_t       numSlots = 1;
+    while (numSlots < 2 * keywords.size()) { numSlots *= 2; }
+    for (bool isOk = keywords.empty(); !isOk;) {
+        for (table.seed = 0; table.seed < 4096 && !isOk; table.seed++) {
+            vector<bool> used(numSlots, false);
+            isOk = true;
+            for (const auto &[key, _] : keywords) {
+                size_t slot = getKeywordHash(key, table.seed) & (numSlots - 1);
+                isOk &= !used[slot];
+                used[slot] = true;
+            }
+        }
+        if (isOk) {
+            table.seed--;
+        } else if (numSlots < (1 << 20)) {
+            numSlots *= 2;
+        } else {
+            logger.debug("lexical keywords kept in DFA: {} keywords, no "
+                         "perfect hash in {} slots",
+                         keywords.size(), numSlots);
+            for (const auto &[key, elem] : keywords) {
+                rules.push_back(elem.first);
+            }
+            keywords.clear();
+            table.seed = 0;
+            isOk       = true;
+        }
+    }
+    std::sort(rules.begin(), rules.end());
+    DFA dfa = getDFAofRules(dfas, rules);
+
+    if (keywords.size() > 0) {
+        table.ids.assign(numSlots, -1);
+        table.hosts.assign(numSlots, -1);
+        table.keys.assign(numSlots, "");
+        table.isHost.assign(regexs.size(), false);
+        for (const auto &[key, elem] : keywords) {
+            size_t slot = getKeywordHash(key, table.seed) & (numSlots - 1);
+            table.ids[slot]           = elem.first;
+            table.hosts[slot]         = elem.second;
+            table.keys[slot]          = key;
+            table.isHost[elem.second] = true;
+        }
+        logger.debug("lexical keywords split off: {} keywords, {} slots, "
+                     "seed {}",
+                     keywords.size(), numSlots, table.seed);
+    }
+    return {dfa, table};
+}
+
+pair<DFAtable, KeywordTable>
+getDFAtableWithKeywords(const vector<string> &regexs, vector<int> *vmRules) {
+    // regexs never contain '\0'
+    DFAcache *cache = getDefaultCache();
+    string    key;
+    for (const string &regex : regexs) { key += regex + '\0'; }
+    DFAtable     table;
+    KeywordTable keywords;
+    if (cache != nullptr && cache->load(key, table, keywords)) {
+        if (vmRules != nullptr) { vmRules->clear(); }
+        return {table, keywords};
+    }
+    vector<int> overRules;
+    DFA         dfa;
+    std::tie(dfa, keywords) = getDFAwithKeywords(
+        regexs, vmRules != nullptr ? &overRules : nullptr);
+    table = getDFAtable(dfa);
+    if (vmRules != nullptr) { *vmRules = overRules; }
+    // a partial DFA (without GlushkovVM rules) is not cached
+    if (cache != nullptr && overRules.empty()) {
+        cache->store(key, table, keywords);
+    }
+    return {table, keywords};
+}
+
+void LexicalParser::setVMs(const vector<string> &regexs,
+                           const vector<int> &vmRules) {
+    vms_.clear();
+    vmIds_ = vmRules;
+    for (int i : vmRules) {
+        logger.warn("lexical rule {} ‘{}’: DFA goes beyond {} states, run by "
+                    "GlushkovVM instead (slower)",
+                    i, unescape(regexs[i]), maxRuleStates);
+        vms_.emplace_back(regexs[i]);
+    }
+    startVM(vm_);
+}
+
+void LexicalParser::startVM(VMstate &vm) const {
+    vm.state = 0;
+    vm.vms.resize(vms_.size());
+    vm.next.resize(vms_.size());
+    vm.isAlive.assign(vms_.size(), true);
+    vm.isNextAlive.assign(vms_.size(), false);
+    for (int i = 0; i < vms_.size(); i++) { vm.vms[i] = vms_[i].start(); }
+}
+
+// step the DFA and all GlushkovVMs still alive, as if they were one DFA
+bool LexicalParser::stepVM(VMstate &vm, unsigned char c) const {
+    int  next    = (vm.state < 0) ? -1 : step(vm.state, c);
+    bool isAlive = (next >= 0);
+    for (int i = 0; i < vms_.size(); i++) {
+        vm.isNextAlive[i] =
+            vm.isAlive[i] && vms_[i].step(vm.vms[i], c, vm.next[i]);
+        isAlive |= vm.isNextAlive[i];
+    }
+    if (!isAlive) { return false; }
+    vm.state = next;
+    std::swap(vm.vms, vm.next);
+    std::swap(vm.isAlive, vm.isNextAlive);
+    return true;
 }
 
+// the least lexical id accepting, like finality of integrated DFA
+int LexicalParser::finalityVM(const VMstate &vm) const {
+    int f = (vm.state < 0) ? 0 : finality(vm.state);
+    for (int i = 0; i < vms_.size(); i++) {
+        if (vm.isAlive[i] && vms_[i].isFinal(vm.vms[i]) &&
+            (f == 0 || vmIds_[i] + 1 < f)) {
+            f = vmIds_[i] + 1;
+        }
+    }
+    return f;
+}
+
+// skip bytes in the self-loop ranges of accel
+// return the first byte out of ranges (or ed)
+static const char *skipSelfLoop(const DFAaccel &accel, const char *p,
+                                const char *ed) {
+#ifdef __SSE2__
+    // byte x in [lo, hi] <=> (uint8_t) (x - lo) <= (hi - lo), 16 bytes a time
+    __m128i lo[4], width[4];
+    for (int i = 0; i < accel.numRanges; i++) {
+        lo[i]    = _mm_set1_epi8(accel.lo[i]);
+        width[i] = _mm_set1_epi8(accel.hi[i] - accel.lo[i]);
+    }
+    for (; ed - p >= 16; p += 16) {
+        __m128i x  = _mm_loadu_si128((const __m128i *) p);
+        __m128i in = _mm_setzero_si128();
+        for (int i = 0; i < accel.numRanges; i++) {
+            __m128i d = _mm_sub_epi8(x, lo[i]);
+            in = _mm_or_si128(in, _mm_cmpeq_epi8(_mm_min_epu8(d, width[i]), d));
+        }
+        unsigned out = ~_mm_movemask_epi8(in) & 0xFFFF;
+        if (out != 0) { return p + __builtin_ctz(out); }
+    }
+#endif
+    for (; p < ed; p++) {
+        uint8_t c    = *p;
+        bool    isIn = false;
+        for (int i = 0; i < accel.numRanges; i++) {
+            isIn |= (uint8_t) (c - accel.lo[i]) <= accel.hi[i] - accel.lo[i];
+        }
+        if (!isIn) { break; }
+    }
+    return p;
+}
 
 // read, until one token is generated
 // return token with lexical id
@@ -56,43 +362,90 @@ Token LexicalParser::parseStep(istream &input) {
     // return end_token when input end
     if (!(input.good() && !input.eof() && !input.fail())) { return END_TOKEN; }
 
-    stringstream buffer;
+    // peek the stream buffer directly, consume a char only when stepped
+    std::streambuf *buf = input.rdbuf();
+    lexeme_.clear();
     while (true) {
-        char c = input.get();
+        int c = buf->sgetc();
 
         // if cannot continue, try to accept token
-        if (dfa_.graph.count(state_) == 0 ||
-            dfa_.graph.at(state_).count(c) == 0) {
-            input.putback(c);
+        if (c == EOF || !stepNow(c)) {
+            if (c == EOF) {
+                input.setstate(ios::eofbit);
+                if (lexeme_.size() == 0) { return END_TOKEN; }
+            }
 
-            // assert(dfa_.finality.at(state_) != 0); // failed
-            if (dfa_.finality.at(state_) == 0) {
+            // assert(finalityNow() != 0); // failed
+            if (finalityNow() == 0) {
+                string unmatched = lexeme_ + (c == EOF ? "" : string(1, c));
                 logger.debug("lexical error: unmatched ‘{}’ in ‘{}’",
-                                buffer.str() + c, unescape(history_ + c));
+                             unmatched, unescape(history_ + unmatched));
                 throw runtime_error(
                     fmt::format("lexical error: unmatched ‘{}’ in ‘{}’",
-                                buffer.str() + c, unescape(history_ + c)));
+                                unmatched, unescape(history_ + unmatched)));
             }
-            int    tokenId       = dfa_.finality.at(state_) - 1;
-            string tokenLexValue = buffer.str();
+            int tokenId = keywords_.find(finalityNow() - 1, lexeme_);
+            state_      = 0;
+            if (!vms_.empty()) { startVM(vm_); }
 
-            state_ = 0;
-            buffer.clear();
+            assert(lexeme_.size() > 0);
+            history_ += lexeme_;
+            if (history_.size() > 20) { history_.erase(0, history_.size() - 10); }
 
-            assert(tokenLexValue.size() > 0);
-            Token token({tokenId, tokenLexValue});
+            Token token({tokenId, lexeme_});
             logger.debug("parsed lexical <token {}> ‘{}’", token.id, unescape(token.lval));
             return token;
         }
 
         // continue
-        state_ = dfa_.graph.at(state_).at(c);
-        buffer << c;
-        history_.push_back(c);
-        if (history_.size() > 20) { history_ = history_.substr(10); }
+        lexeme_.push_back(c);
+        buf->sbumpc();
     }
 }
 
+// read one token from buffer, starting at offset (offset moves forward)
+// return token located in buffer, END_SYMBOL token at the end of buffer
+TokenView LexicalParser::parseStep(string_view input, size_t &offset) const {
+    if (offset >= input.size()) { return {END_SYMBOL, input.size(), 0}; }
+
+    const char *st    = input.data() + offset;
+    const char *ed    = input.data() + input.size();
+    const char *p     = st;
+    int         state = 0;
+    if (vms_.empty()) {
+        for (int next; p < ed && (next = step(state, *p)) >= 0; p++) {
+            // entered a self-loop, skip the rest of it at once
+            if (next == state && accelerated_ && accels_[state].numRanges > 0) {
+                p = skipSelfLoop(accels_[state], p + 1, ed) - 1;
+            }
+            state = next;
+        }
+        state = finality(state);
+    } else {
+        VMstate vm;
+        startVM(vm);
+        for (; p < ed && stepVM(vm, *p); p++) {}
+        state = finalityVM(vm);
+    }
+
+    // state is its finality from now on
+    if (state == 0) {
+        size_t unmatchedEd = std::min<size_t>(p - input.data() + 1, input.size());
+        size_t historySt   = offset > 10 ? offset - 10 : 0;
+        string unmatched(input.substr(offset, unmatchedEd - offset));
+        string history(input.substr(historySt, unmatchedEd - historySt));
+        logger.debug("lexical error: unmatched ‘{}’ in ‘{}’", unmatched,
+                     unescape(history));
+        throw runtime_error(fmt::format("lexical error: unmatched ‘{}’ in ‘{}’",
+                                        unmatched, unescape(history)));
+    }
+    assert(p > st);
+    int       tokenId = keywords_.find(state - 1, string_view(st, p - st));
+    TokenView token({tokenId, offset, (size_t) (p - st)});
+    offset += token.length;
+    return token;
+}
+
 // read, until the end of input (END_TOKEN is generated)
 // return tokens with lexical id
 vector<Token> LexicalParser::parseAll(istream &input) {
@@ -104,9 +457,516 @@ vector<Token> LexicalParser::parseAll(istream &input) {
     return tokens;
 }
 
+// read, until the end of buffer (END_SYMBOL token is appended)
+// tokens are appended to the columns of token buffer
+void LexicalParser::parseAll(string_view input, TokenBuffer &tokens) const {
+    // estimated by ~4 bytes per token, to avoid most reallocations
+    tokens.reserve(tokens.size() + input.size() / 4 + 1);
+    size_t offset = 0;
+    do {
+        tokens.push_back(parseStep(input, offset));
+    } while (tokens.ids.back() != END_SYMBOL);
+}
+
+// lex input[st, ed) from state, without going back to the token start:
+// a token ends before the byte where state cannot step, then the byte
+// steps from state 0 again (the same as parseStep does)
+// append {end of token} and {lexical id before keyword lookup}
+// return false on lexical error
+bool LexicalParser::lexChunk(int &state, const char *base, size_t st,
+                             size_t ed, vector<size_t> &ends,
+                             vector<int> &ids) const {
+    const char *p = base + st;
+    for (; p < base + ed; p++) {
+        int next = step(state, *p);
+        if (next < 0) {
+            if (finality(state) == 0) { return false; }
+            ends.push_back(p - base);
+            ids.push_back(finality(state) - 1);
+            if ((next = step(0, *p)) < 0) { return false; }
+        } else if (next == state && accelerated_ &&
+                   accels_[state].numRanges > 0) {
+            p = skipSelfLoop(accels_[state], p + 1, base + ed) - 1;
+        }
+        state = next;
+    }
+    return true;
+}
+
+// read, until the end of buffer (END_SYMBOL token is appended), the same
+// as parseAll, but input is split into chunks lexed by threads
+// the state entering a chunk is unknown until the previous chunks are done,
+// so each chunk is lexed from all states at once, until they converge into
+// one (usually in a few bytes); the chunks are then stitched in order, with
+// only the bytes before convergence lexed again from the real state
+void LexicalParser::parseAllParallel(string_view input, TokenBuffer &tokens,
+                                     int threads) const {
+    size_t numChunks = std::min<size_t>(std::max(threads, 1), input.size());
+    // lazy DFA (or GlushkovVM) cannot be speculated from all states
+    if (numChunks <= 1 || lazy_ || !vms_.empty()) {
+        parseAll(input, tokens);
+        return;
+    }
+
+    struct Chunk {
+        size_t         st, ed;
+        bool           isSynced  = false; // entering states converged
+        size_t         syncPos   = 0;
+        int            syncState = 0;
+        bool           isOk      = true; // no lexical error after syncPos
+        int            endState  = 0;
+        vector<size_t> ends; // tokens before syncPos, filled when stitching
+        vector<int>    ids;
+        vector<size_t> syncEnds; // tokens after syncPos
+        vector<int>    syncIds;
+        size_t         tokenSt = 0; // index of first token in buffer
+        size_t         prevEnd = 0; // end of the token before chunk
+    };
+    vector<Chunk> chunks(numChunks);
+    for (size_t k = 0; k < numChunks; k++) {
+        chunks[k].st = input.size() * k / numChunks;
+        chunks[k].ed = input.size() * (k + 1) / numChunks;
+    }
+    const char *base = input.data();
+
+    auto speculate = [&](Chunk &chunk, bool isFirst) {
+        // lex from all states until they converge (the first chunk starts
+        // from state 0), dead states are dropped
+        vector<int> states({0});
+        if (!isFirst) {
+            states.resize(table_.numStates);
+            for (int i = 0; i < table_.numStates; i++) { states[i] = i; }
+        }
+        size_t pos = chunk.st;
+        while (states.size() > 1 && pos < chunk.ed) {
+            unsigned char c = base[pos++];
+            size_t        n = 0;
+            for (int state : states) {
+                int next = step(state, c);
+                if (next < 0 && finality(state) != 0) {
+                    next = step(0, c);
+                }
+                if (next >= 0) { states[n++] = next; }
+            }
+            states.resize(n);
+            std::sort(states.begin(), states.end());
+            states.erase(std::unique(states.begin(), states.end()),
+                         states.end());
+        }
+        if (states.size() != 1) { return; } // all dead, or not converged
+        chunk.isSynced  = true;
+        chunk.syncPos   = pos;
+        chunk.syncState = states[0];
+        chunk.endState  = states[0];
+        chunk.isOk = lexChunk(chunk.endState, base, pos, chunk.ed,
+                              chunk.syncEnds, chunk.syncIds);
+    };
+    auto fill = [&](Chunk &chunk) {
+        size_t i       = chunk.tokenSt;
+        size_t prevEnd = chunk.prevEnd;
+        for (auto *list : {&chunk.ends, &chunk.syncEnds}) {
+            auto &ids = (list == &chunk.ends) ? chunk.ids : chunk.syncIds;
+            for (size_t j = 0; j < list->size(); j++, i++) {
+                size_t end        = (*list)[j];
+                tokens.offsets[i] = prevEnd;
+                tokens.lengths[i] = end - prevEnd;
+                tokens.ids[i]     = keywords_.find(
+                    ids[j], string_view(base + prevEnd, end - prevEnd));
+                prevEnd = end;
+            }
+        }
+    };
+    auto runParallel = [&](auto func) {
+        vector<std::thread> workers;
+        for (size_t k = 1; k < numChunks; k++) {
+            workers.emplace_back(func, k);
+        }
+        func(0);
+        for (auto &worker : workers) { worker.join(); }
+    };
+
+    runParallel([&](size_t k) { speculate(chunks[k], k == 0); });
+
+    // stitch in order, lex again the bytes before convergence
+    int    state   = 0;
+    bool   isOk    = true;
+    size_t prevEnd = 0;
+    for (Chunk &chunk : chunks) {
+        size_t syncPos = chunk.isSynced ? chunk.syncPos : chunk.ed;
+        chunk.prevEnd  = prevEnd;
+        isOk = lexChunk(state, base, chunk.st, syncPos, chunk.ends, chunk.ids);
+        if (isOk && chunk.isSynced) {
+            // desynced speculation, never expected, lexed again sequentially
+            isOk  = chunk.isOk && state == chunk.syncState;
+            state = chunk.endState;
+        }
+        if (!isOk) { break; }
+        if (chunk.ends.size() > 0) { prevEnd = chunk.ends.back(); }
+        if (chunk.syncEnds.size() > 0) { prevEnd = chunk.syncEnds.back(); }
+    }
+    // the last token, at the end of input
+    if (isOk && prevEnd < input.size()) {
+        isOk = (finality(state) != 0);
+        chunks.back().syncEnds.push_back(input.size());
+        chunks.back().syncIds.push_back(finality(state) - 1);
+    }
+    if (!isOk) {
+        parseAll(input, tokens); // the same lexical error, or tokens
+        return;
+    }
+
+    size_t numTokens = tokens.size();
+    for (Chunk &chunk : chunks) {
+        chunk.tokenSt = numTokens;
+        numTokens += chunk.ends.size() + chunk.syncEnds.size();
+    }
+    tokens.ids.resize(numTokens);
+    tokens.offsets.resize(numTokens);
+    tokens.lengths.resize(numTokens);
+    runParallel([&](size_t k) { fill(chunks[k]); });
+    tokens.push_back({END_SYMBOL, input.size(), 0});
+}
+
+// emit lexeme_ + [st, ed) as a token, stuck by c (EOF if at finish)
+void LexicalParser::pushToken(const char *st, const char *ed, int c) {
+    string_view lval(st, ed - st);
+    if (lexeme_.size() > 0) {
+        if (st < ed) { lexeme_.append(st, ed - st); }
+        lval = lexeme_;
+    }
+    if (lval.size() == 0 || finalityNow() == 0) {
+        string unmatched = string(lval) + (c == EOF ? "" : string(1, c));
+        logger.debug("lexical error: unmatched ‘{}’ in ‘{}’", unmatched,
+                     unescape(history_ + unmatched));
+        throw runtime_error(fmt::format("lexical error: unmatched ‘{}’ in ‘{}’",
+                                        unmatched,
+                                        unescape(history_ + unmatched)));
+    }
+    int tokenId = keywords_.find(finalityNow() - 1, lval);
+    tokenFunc_(tokenId, lval);
+
+    history_.append(lval.substr(lval.size() > 10 ? lval.size() - 10 : 0));
+    if (history_.size() > 20) { history_.erase(0, history_.size() - 10); }
+    lexeme_.clear();
+    state_ = 0;
+    if (!vms_.empty()) { startVM(vm_); }
+}
+
+// run until stuck then accept, the same as parseStep(istream &), but only
+// the unfinished lexeme at the end of data is copied and kept
+void LexicalParser::feed(const char *data, size_t size) {
+    const char *st = data; // start of current lexeme in data
+    const char *ed = data + size;
+    for (const char *p = data; p < ed && !vms_.empty();) {
+        if (stepNow(*p)) {
+            p++;
+        } else {
+            pushToken(st, p, (unsigned char) *p);
+            st = p;
+        }
+    }
+    for (const char *p = data; p < ed && vms_.empty();) {
+        int next = step(state_, *p);
+        if (next < 0) {
+            pushToken(st, p, (unsigned char) *p);
+            st = p;
+            continue;
+        }
+        // entered a self-loop, skip the rest of it at once
+        if (next == state_ && accelerated_ && accels_[state_].numRanges > 0) {
+            p = skipSelfLoop(accels_[state_], p + 1, ed);
+        } else {
+            p++;
+        }
+        state_ = next;
+    }
+
+    if (lexeme_.size() + (ed - st) > maxLexeme_) {
+        throw runtime_error(fmt::format(
+            "lexical error: lexeme longer than {} bytes", maxLexeme_));
+    }
+    lexeme_.append(st, ed - st);
+}
+
+void LexicalParser::finish() {
+    if (lexeme_.size() > 0) { pushToken(nullptr, nullptr, EOF); }
+    tokenFunc_(END_SYMBOL, "");
+    clear();
+}
+
 void LexicalParser::clear() {
     state_ = 0;
-    history_ = "";
+    if (!vms_.empty()) { startVM(vm_); }
+    lexeme_.clear();
+    history_.clear();
+}
+
+// ---------- LexicalSpec ----------
+
+LexicalSpec::LexicalSpec(const vector<string> &regexs)
+    : regexs_(regexs), isRemoved_(regexs.size(), false) {
+    vector<DFA> dfas(regexs.size());
+    krill::utils::parallel_for(regexs.size(), [&](size_t i) {
+        dfas[i] = getMinimizedDfa(getDFAfromRegex(regexs[i]));
+        for (auto &[state, finality] : dfas[i].finality) {
+            if (finality != 0) { finality = i + 1; }
+        }
+    });
+
+    // subset construction, like getDFAintegrated, but every rule accepted
+    // by a state is kept (not only the least one), for later removal
+    NFA nfa                   = getNFAintegrated(dfas);
+    auto [graph, closureMap]  = getClosureMapfromNFAgraph(nfa.graph);
+    DFA                 core  = {graph, {{0, 0}}};
+    vector<vector<int>> acceptSets({{}});
+    for (const auto &[state, closure] : closureMap) {
+        vector<int> ids;
+        for (int nfaState : closure) {
+            auto it = nfa.finality.find(nfaState);
+            if (it != nfa.finality.end() && it->second != 0) {
+                ids.push_back(it->second - 1);
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        core.finality[state] = acceptSets.size();
+        acceptSets.push_back(ids);
+    }
+    setCore(core, acceptSets);
+}
+
+int LexicalSpec::addRule(const string &regex) {
+    int id   = regexs_.size();
+    DFA rule = getMinimizedDfa(getDFAfromRegex(regex));
+    regexs_.push_back(regex);
+    isRemoved_.push_back(false);
+
+    // product states {core, rule} (core -1 if stuck) while the rule goes
+    // on; once it is stuck, {i, -1} is just core state i, minimal already,
+    // and never equivalent to a product state (where the rule can accept)
+    struct Move {
+        int  symbol, to; // to: product state, or core state if !isPair
+        bool isPair;
+    };
+    static const map<int, int>       noEdges;
+    vector<pair<int, int>>           pairs({{0, 0}});
+    std::unordered_map<int64_t, int> pairIdx({{0, 0}});
+    auto intern = [&](int i, int r) -> int {
+        auto [it, isNew] = pairIdx.emplace(((int64_t) i << 32) | (uint32_t) r,
+                                           pairs.size());
+        if (isNew) { pairs.push_back({i, r}); }
+        return it->second;
+    };
+    auto edgesOf = [](const DFA &dfa, int state) -> const map<int, int> & {
+        auto it = dfa.graph.find(state);
+        return (state < 0 || it == dfa.graph.end()) ? noEdges : it->second;
+    };
+    vector<vector<Move>> moves;
+    vector<vector<int>>  acceptSets;
+    for (int k = 0; k < pairs.size(); k++) {
+        auto [i, r]     = pairs[k];
+        vector<int> ids = (i < 0) ? vector<int>()
+                                  : acceptSets_[core_.finality.at(i)];
+        if (rule.finality[r] != 0) { ids.push_back(id); }
+        acceptSets.push_back(std::move(ids));
+
+        // walk the two sorted edge lists at once
+        const map<int, int> &a = edgesOf(core_, i), &b = edgesOf(rule, r);
+        vector<Move>         pairMoves;
+        auto                 itA = a.begin(), itB = b.begin();
+        while (itA != a.end() || itB != b.end()) {
+            int symbol = (itB == b.end() ||
+                          (itA != a.end() && itA->first < itB->first))
+                             ? itA->first
+                             : itB->first;
+            int nextI = -1, nextR = -1;
+            if (itA != a.end() && itA->first == symbol) {
+                nextI = (itA++)->second;
+            }
+            if (itB != b.end() && itB->first == symbol) {
+                nextR = (itB++)->second;
+            }
+            pairMoves.push_back((nextR >= 0)
+                                    ? Move{symbol, intern(nextI, nextR), true}
+                                    : Move{symbol, nextI, false});
+        }
+        moves.push_back(std::move(pairMoves));
+    }
+
+    // minimize the product states only (Moore), core states are classes
+    // of their own
+    vector<int> classOf(pairs.size());
+    int         numClasses;
+    {
+        map<vector<int>, int> classIdx;
+        for (int k = 0; k < pairs.size(); k++) {
+            classOf[k] = classIdx.emplace(acceptSets[k], classIdx.size())
+                             .first->second;
+        }
+        numClasses = classIdx.size();
+    }
+    while (true) {
+        map<vector<int>, int> classIdx;
+        vector<int>           nextClassOf(pairs.size());
+        for (int k = 0; k < pairs.size(); k++) {
+            vector<int> signature({classOf[k]});
+            for (const Move &move : moves[k]) {
+                signature.push_back(move.symbol);
+                signature.push_back(move.isPair ? classOf[move.to]
+                                                : -1 - move.to);
+            }
+            nextClassOf[k] =
+                classIdx.emplace(signature, classIdx.size()).first->second;
+        }
+        classOf.swap(nextClassOf);
+        if (classIdx.size() == numClasses) { break; }
+        numClasses = classIdx.size();
+    }
+
+    // classes join the core as new states, the class of {0, 0} is the
+    // new start state 0
+    int         nextState = core_.finality.rbegin()->first + 1;
+    vector<int> stateOf(numClasses, -1);
+    for (int k = 0; k < pairs.size(); k++) {
+        if (stateOf[classOf[k]] < 0) { stateOf[classOf[k]] = nextState++; }
+    }
+    map<vector<int>, int> labelOf;
+    for (int label = 0; label < acceptSets_.size(); label++) {
+        labelOf.emplace(acceptSets_[label], label);
+    }
+    for (int k = 0; k < pairs.size(); k++) {
+        int state = stateOf[classOf[k]];
+        if (core_.finality.count(state)) { continue; }
+        auto [it, isNew] = labelOf.emplace(acceptSets[k], acceptSets_.size());
+        if (isNew) { acceptSets_.push_back(acceptSets[k]); }
+        core_.finality[state] = it->second;
+        for (const Move &move : moves[k]) {
+            core_.graph[state][move.symbol] =
+                move.isPair ? stateOf[classOf[move.to]] : move.to;
+        }
+    }
+    int  start     = stateOf[classOf[0]];
+    auto swapState = [start](auto &states) {
+        auto oldStart = states.extract(0), newStart = states.extract(start);
+        if (oldStart) {
+            oldStart.key() = start;
+            states.insert(std::move(oldStart));
+        }
+        if (newStart) {
+            newStart.key() = 0;
+            states.insert(std::move(newStart));
+        }
+    };
+    for (auto &[from, edges] : core_.graph) {
+        for (auto &[symbol, to] : edges) {
+            to = (to == 0) ? start : (to == start) ? 0 : to;
+        }
+    }
+    swapState(core_.graph);
+    swapState(core_.finality);
+
+    // drop core states not reachable any more
+    set<int>    reachable({0});
+    vector<int> queue({0});
+    while (!queue.empty()) {
+        int state = queue.back();
+        queue.pop_back();
+        for (const auto &[symbol, to] : edgesOf(core_, state)) {
+            if (reachable.insert(to).second) { queue.push_back(to); }
+        }
+    }
+    for (auto it = core_.finality.begin(); it != core_.finality.end();) {
+        if (reachable.count(it->first) == 0) {
+            core_.graph.erase(it->first);
+            it = core_.finality.erase(it);
+        } else {
+            it++;
+        }
+    }
+    return id;
+}
+
+void LexicalSpec::removeRule(int id) {
+    if (id < 0 || id >= regexs_.size() || isRemoved_[id]) {
+        throw runtime_error(
+            fmt::format("lexical spec: no rule {} to remove", id));
+    }
+    regexs_[id]    = "";
+    isRemoved_[id] = true;
+    vector<vector<int>> acceptSets = acceptSets_;
+    for (vector<int> &ids : acceptSets) {
+        ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+    }
+    setCore(core_, acceptSets);
+}
+
+// core's finality is index of acceptSets (maybe duplicated)
+void LexicalSpec::setCore(DFA core, const vector<vector<int>> &acceptSets) {
+    // drop states accepting nothing later on (e.g. only the removed rule
+    // went on there), so that lexing gets stuck before them as it should
+    map<int, vector<int>> froms;
+    for (const auto &[from, edges] : core.graph) {
+        for (const auto &[symbol, to] : edges) { froms[to].push_back(from); }
+    }
+    set<int>    alive;
+    vector<int> queue;
+    for (const auto &[state, label] : core.finality) {
+        if (!acceptSets[label].empty() && alive.insert(state).second) {
+            queue.push_back(state);
+        }
+    }
+    while (!queue.empty()) {
+        int state = queue.back();
+        queue.pop_back();
+        for (int from : froms[state]) {
+            if (alive.insert(from).second) { queue.push_back(from); }
+        }
+    }
+    alive.insert(0);
+    for (auto it = core.graph.begin(); it != core.graph.end();) {
+        if (alive.count(it->first) == 0) {
+            it = core.graph.erase(it);
+            continue;
+        }
+        for (auto it2 = it->second.begin(); it2 != it->second.end();) {
+            it2 = alive.count(it2->second) ? std::next(it2)
+                                           : it->second.erase(it2);
+        }
+        it++;
+    }
+
+    // the same sets, the same label, so that states are merged by them
+    map<vector<int>, int> labelOf({{{}, 0}});
+    acceptSets_ = {{}};
+    for (auto it = core.finality.begin(); it != core.finality.end();) {
+        if (alive.count(it->first) == 0) {
+            it = core.finality.erase(it);
+            continue;
+        }
+        const vector<int> &ids  = acceptSets[it->second];
+        auto [it2, isNew] = labelOf.emplace(ids, acceptSets_.size());
+        if (isNew) { acceptSets_.push_back(ids); }
+        (it++)->second = it2->second;
+    }
+    core_ = getMinimizedDfa(core);
+}
+
+DFA LexicalSpec::dfa() const {
+    DFA dfa = core_;
+    for (auto &[state, finality] : dfa.finality) {
+        const vector<int> &ids = acceptSets_[finality];
+        finality               = ids.empty() ? 0 : ids.front() + 1;
+    }
+    return getReachableDfa(dfa);
+}
+
+LexicalParser LexicalSpec::parser() const {
+    DFAtable table = getDFAtable(core_);
+    for (int32_t &finality : table.finality) {
+        const vector<int> &ids = acceptSets_[finality];
+        finality               = ids.empty() ? 0 : ids.front() + 1;
+    }
+    return LexicalParser(table);
 }
 
 } // namespace krill::runtime
\ No newline at end of file
@@ -7,8 +7,11 @@
 #include "krill/lexical.h"
 #include "krill/syntax.h"
 #include "krill/utils.h"
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <set>
 #include <vector>
@@ -1376,7 +1379,7 @@ namespace krill::minic::lexical {
 //  7: return
 //  8: \|\|
 //  9: &&
-// 10: [a-zA-Z]([a-zA-Z]|([0-9])|([1-9][0-9]*))*
+// 10: [a-zA-Z_]([a-zA-Z_]|[0-9])*
 // 11: 0(x|X)([a-zA-Z]|[0-9])*
 // 12: ([0-9])|([1-9][0-9]*)[1-9]*
 // 13: \<=
@@ -1411,7 +1414,6 @@ namespace krill::minic::lexical {
 // 42: //[^\n\r]*
 // 43: /\*
 // 44: \!
-// 45: for
 
 // clang-format off
 const DFAgraph graph = {
@@ -1425,30 +1427,21 @@ const DFAgraph graph = {
          {78, 21},  {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},
          {84, 21},  {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},
          {90, 21},  {91, 22},  {93, 23},  {94, 24},  {95, 21},  {97, 21},
-         {98, 25},  {99, 26},  {100, 21}, {101, 27}, {102, 21}, {103, 21},
-         {104, 21}, {105, 28}, {106, 21}, {107, 21}, {108, 21}, {109, 21},
-         {110, 21}, {111, 21}, {112, 21}, {113, 21}, {114, 29}, {115, 21},
-         {116, 21}, {117, 21}, {118, 30}, {119, 31}, {120, 21}, {121, 21},
-         {122, 21}, {123, 32}, {124, 33}, {125, 34}, {126, 35}}},
+         {98, 21},  {99, 21},  {100, 21}, {101, 21}, {102, 21}, {103, 21},
+         {104, 21}, {105, 21}, {106, 21}, {107, 21}, {108, 21}, {109, 21},
+         {110, 21}, {111, 21}, {112, 21}, {113, 21}, {114, 21}, {115, 21},
+         {116, 21}, {117, 21}, {118, 21}, {119, 21}, {120, 21}, {121, 21},
+         {122, 21}, {123, 25}, {124, 26}, {125, 27}, {126, 28}}},
     {3, {{10, 2}}},
-    {4, {{61, 36}}},
-    {7, {{38, 37}}},
-    {14, {{42, 38}, {47, 39}}},
-    {15, {{88, 40}, {120, 40}}},
-    {16,
-     {{48, 16},
-      {49, 16},
-      {50, 16},
-      {51, 16},
-      {52, 16},
-      {53, 16},
-      {54, 16},
-      {55, 16},
-      {56, 16},
-      {57, 16}}},
-    {18, {{60, 41}, {61, 42}}},
-    {19, {{61, 43}}},
-    {20, {{61, 44}, {62, 45}}},
+    {4, {{61, 29}}},
+    {7, {{38, 30}}},
+    {14, {{42, 31}, {47, 32}}},
+    {15, {{88, 33}, {120, 33}}},
+    {16, {{48, 16}, {49, 16}, {50, 16}, {51, 16}, {52, 16}, {53, 16},
+          {54, 16}, {55, 16}, {56, 16}, {57, 16}}},
+    {18, {{60, 34}, {61, 35}}},
+    {19, {{61, 36}}},
+    {20, {{61, 37}, {62, 38}}},
     {21, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
           {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
           {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
@@ -1460,435 +1453,39 @@ const DFAgraph graph = {
           {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
           {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
           {120, 21}, {121, 21}, {122, 21}}},
-    {25, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 46}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {26, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 47}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {27, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 48}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {28, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 49}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 50}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {29, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 51},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {30, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 52}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {31, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 53}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {33, {{124, 54}}},
-    {39, {{1, 39},   {2, 39},   {3, 39},   {4, 39},   {5, 39},   {6, 39},
-          {7, 39},   {8, 39},   {9, 39},   {11, 39},  {12, 39},  {14, 39},
-          {15, 39},  {16, 39},  {17, 39},  {18, 39},  {19, 39},  {20, 39},
-          {21, 39},  {22, 39},  {23, 39},  {24, 39},  {25, 39},  {26, 39},
-          {27, 39},  {28, 39},  {29, 39},  {30, 39},  {31, 39},  {32, 39},
-          {33, 39},  {34, 39},  {35, 39},  {36, 39},  {37, 39},  {38, 39},
-          {39, 39},  {40, 39},  {41, 39},  {42, 39},  {43, 39},  {44, 39},
-          {45, 39},  {46, 39},  {47, 39},  {48, 39},  {49, 39},  {50, 39},
-          {51, 39},  {52, 39},  {53, 39},  {54, 39},  {55, 39},  {56, 39},
-          {57, 39},  {58, 39},  {59, 39},  {60, 39},  {61, 39},  {62, 39},
-          {63, 39},  {64, 39},  {65, 39},  {66, 39},  {67, 39},  {68, 39},
-          {69, 39},  {70, 39},  {71, 39},  {72, 39},  {73, 39},  {74, 39},
-          {75, 39},  {76, 39},  {77, 39},  {78, 39},  {79, 39},  {80, 39},
-          {81, 39},  {82, 39},  {83, 39},  {84, 39},  {85, 39},  {86, 39},
-          {87, 39},  {88, 39},  {89, 39},  {90, 39},  {91, 39},  {92, 39},
-          {93, 39},  {94, 39},  {95, 39},  {96, 39},  {97, 39},  {98, 39},
-          {99, 39},  {100, 39}, {101, 39}, {102, 39}, {103, 39}, {104, 39},
-          {105, 39}, {106, 39}, {107, 39}, {108, 39}, {109, 39}, {110, 39},
-          {111, 39}, {112, 39}, {113, 39}, {114, 39}, {115, 39}, {116, 39},
-          {117, 39}, {118, 39}, {119, 39}, {120, 39}, {121, 39}, {122, 39},
-          {123, 39}, {124, 39}, {125, 39}, {126, 39}, {127, 39}}},
-    {40, {{48, 40},  {49, 40},  {50, 40},  {51, 40},  {52, 40},  {53, 40},
-          {54, 40},  {55, 40},  {56, 40},  {57, 40},  {65, 40},  {66, 40},
-          {67, 40},  {68, 40},  {69, 40},  {70, 40},  {71, 40},  {72, 40},
-          {73, 40},  {74, 40},  {75, 40},  {76, 40},  {77, 40},  {78, 40},
-          {79, 40},  {80, 40},  {81, 40},  {82, 40},  {83, 40},  {84, 40},
-          {85, 40},  {86, 40},  {87, 40},  {88, 40},  {89, 40},  {90, 40},
-          {97, 40},  {98, 40},  {99, 40},  {100, 40}, {101, 40}, {102, 40},
-          {103, 40}, {104, 40}, {105, 40}, {106, 40}, {107, 40}, {108, 40},
-          {109, 40}, {110, 40}, {111, 40}, {112, 40}, {113, 40}, {114, 40},
-          {115, 40}, {116, 40}, {117, 40}, {118, 40}, {119, 40}, {120, 40},
-          {121, 40}, {122, 40}}},
-    {46, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 55},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {47, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 56}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {48, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 57}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {49, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {50, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 58}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {51, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 59}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {52, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 60}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {53, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 61}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {55, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 62},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {56, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 63}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {57, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 64},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {58, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {59, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 65}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {60, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 66}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {61, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 67}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {62, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 68},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {63, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 69}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {64, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {65, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 70}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {66, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {67, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 71},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {68, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {69, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 72}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {70, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 73}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {71, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {72, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 74}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {73, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {74, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 75},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
-    {75, {{48, 21},  {49, 21},  {50, 21},  {51, 21},  {52, 21},  {53, 21},
-          {54, 21},  {55, 21},  {56, 21},  {57, 21},  {65, 21},  {66, 21},
-          {67, 21},  {68, 21},  {69, 21},  {70, 21},  {71, 21},  {72, 21},
-          {73, 21},  {74, 21},  {75, 21},  {76, 21},  {77, 21},  {78, 21},
-          {79, 21},  {80, 21},  {81, 21},  {82, 21},  {83, 21},  {84, 21},
-          {85, 21},  {86, 21},  {87, 21},  {88, 21},  {89, 21},  {90, 21},
-          {95, 21},  {97, 21},  {98, 21},  {99, 21},  {100, 21}, {101, 21},
-          {102, 21}, {103, 21}, {104, 21}, {105, 21}, {106, 21}, {107, 21},
-          {108, 21}, {109, 21}, {110, 21}, {111, 21}, {112, 21}, {113, 21},
-          {114, 21}, {115, 21}, {116, 21}, {117, 21}, {118, 21}, {119, 21},
-          {120, 21}, {121, 21}, {122, 21}}},
+    {26, {{124, 39}}},
+    {32, {{1, 32},   {2, 32},   {3, 32},   {4, 32},   {5, 32},   {6, 32},
+          {7, 32},   {8, 32},   {9, 32},   {11, 32},  {12, 32},  {14, 32},
+          {15, 32},  {16, 32},  {17, 32},  {18, 32},  {19, 32},  {20, 32},
+          {21, 32},  {22, 32},  {23, 32},  {24, 32},  {25, 32},  {26, 32},
+          {27, 32},  {28, 32},  {29, 32},  {30, 32},  {31, 32},  {32, 32},
+          {33, 32},  {34, 32},  {35, 32},  {36, 32},  {37, 32},  {38, 32},
+          {39, 32},  {40, 32},  {41, 32},  {42, 32},  {43, 32},  {44, 32},
+          {45, 32},  {46, 32},  {47, 32},  {48, 32},  {49, 32},  {50, 32},
+          {51, 32},  {52, 32},  {53, 32},  {54, 32},  {55, 32},  {56, 32},
+          {57, 32},  {58, 32},  {59, 32},  {60, 32},  {61, 32},  {62, 32},
+          {63, 32},  {64, 32},  {65, 32},  {66, 32},  {67, 32},  {68, 32},
+          {69, 32},  {70, 32},  {71, 32},  {72, 32},  {73, 32},  {74, 32},
+          {75, 32},  {76, 32},  {77, 32},  {78, 32},  {79, 32},  {80, 32},
+          {81, 32},  {82, 32},  {83, 32},  {84, 32},  {85, 32},  {86, 32},
+          {87, 32},  {88, 32},  {89, 32},  {90, 32},  {91, 32},  {92, 32},
+          {93, 32},  {94, 32},  {95, 32},  {96, 32},  {97, 32},  {98, 32},
+          {99, 32},  {100, 32}, {101, 32}, {102, 32}, {103, 32}, {104, 32},
+          {105, 32}, {106, 32}, {107, 32}, {108, 32}, {109, 32}, {110, 32},
+          {111, 32}, {112, 32}, {113, 32}, {114, 32}, {115, 32}, {116, 32},
+          {117, 32}, {118, 32}, {119, 32}, {120, 32}, {121, 32}, {122, 32},
+          {123, 32}, {124, 32}, {125, 32}, {126, 32}, {127, 32}}},
+    {33, {{48, 33},  {49, 33},  {50, 33},  {51, 33},  {52, 33},  {53, 33},
+          {54, 33},  {55, 33},  {56, 33},  {57, 33},  {65, 33},  {66, 33},
+          {67, 33},  {68, 33},  {69, 33},  {70, 33},  {71, 33},  {72, 33},
+          {73, 33},  {74, 33},  {75, 33},  {76, 33},  {77, 33},  {78, 33},
+          {79, 33},  {80, 33},  {81, 33},  {82, 33},  {83, 33},  {84, 33},
+          {85, 33},  {86, 33},  {87, 33},  {88, 33},  {89, 33},  {90, 33},
+          {97, 33},  {98, 33},  {99, 33},  {100, 33}, {101, 33}, {102, 33},
+          {103, 33}, {104, 33}, {105, 33}, {106, 33}, {107, 33}, {108, 33},
+          {109, 33}, {110, 33}, {111, 33}, {112, 33}, {113, 33}, {114, 33},
+          {115, 33}, {116, 33}, {117, 33}, {118, 33}, {119, 33}, {120, 33},
+          {121, 33}, {122, 33}}},
 };
 // clang-format on
 
@@ -1896,17 +1493,20 @@ const map<int, int> finality = {
     {0, 0},   {1, 40},  {2, 41},  {3, 0},   {4, 45},  {5, 42},  {6, 24},
     {7, 33},  {8, 30},  {9, 31},  {10, 25}, {11, 26}, {12, 20}, {13, 27},
     {14, 28}, {15, 13}, {16, 13}, {17, 21}, {18, 19}, {19, 29}, {20, 18},
-    {21, 11}, {22, 35}, {23, 36}, {24, 34}, {25, 11}, {26, 11}, {27, 11},
-    {28, 11}, {29, 11}, {30, 11}, {31, 11}, {32, 22}, {33, 39}, {34, 23},
-    {35, 32}, {36, 17}, {37, 10}, {38, 44}, {39, 43}, {40, 12}, {41, 37},
-    {42, 14}, {43, 16}, {44, 15}, {45, 38}, {46, 11}, {47, 11}, {48, 11},
-    {49, 3},  {50, 11}, {51, 11}, {52, 11}, {53, 11}, {54, 9},  {55, 11},
-    {56, 11}, {57, 11}, {58, 7},  {59, 11}, {60, 11}, {61, 11}, {62, 11},
-    {63, 11}, {64, 5},  {65, 11}, {66, 1},  {67, 11}, {68, 6},  {69, 11},
-    {70, 11}, {71, 4},  {72, 11}, {73, 8},  {74, 11}, {75, 2}};
+    {21, 11}, {22, 35}, {23, 36}, {24, 34}, {25, 22}, {26, 39}, {27, 23},
+    {28, 32}, {29, 17}, {30, 10}, {31, 44}, {32, 43}, {33, 12}, {34, 37},
+    {35, 14}, {36, 16}, {37, 15}, {38, 38}, {39, 9}};
 
 const DFA dfa({.graph = graph, .finality = finality});
 
+// keywords split off the DFA, recognized as identifier (10) at first
+const KeywordTable keywordTable({
+    .seed   = 23,
+    .ids    = {-1, -1, -1, 4, 0, 2, -1, -1, -1, 1, -1, 3, 7, 5, -1, 6},
+    .hosts  = {-1, -1, -1, 10, 10, 10, -1, -1, -1, 10, -1, 10, 10, 10, -1, 10},
+    .keys   = {"", "", "", "else", "void", "if", "", "", "", "continue", "", "while", "return", "break", "", "int"},
+    .isHost = {false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false}});
+
 } // namespace krill::minic::lexical
 
 
@@ -1914,58 +1514,51 @@ namespace krill::minic {
 
 // ---------- MinicParser ----------
 
-void MinicParser::count(char c) {
-    if (c == '\n') {
-        row_lex_ += 1;
-        col_lex_ = 1;
-    } else if (c == '\t') {
-        // col_ = ((col_ + 3) / 4) * 4 + 1; // bad
-        col_lex_ += 1;
-        while (col_lex_ % 8 != 1) { col_lex_ += 1; } // good
-    } else {
-        col_lex_ += 1;
+void MinicParser::indexLines() const {
+    // memchr is vectorized by libc, much faster than bookkeeping per char
+    const char *base = source_.data();
+    const char *ed   = base + source_.size();
+    const char *p    = base + indexed_;
+    while ((p = (const char *) memchr(p, '\n', ed - p)) != nullptr) {
+        lineStarts_.push_back(++p - base);
     }
-    // update source, by the way
-    source_ << c;
-    if (sourceLines_.size() == 0) { sourceLines_.push_back({}); }
-    if (c == '\n') {
-        sourceLines_.push_back({});
-    } else {
-        sourceLines_.back() << c;
+    indexed_ = source_.size();
+}
+
+pair<int, int> MinicParser::getLocation(int pos) const {
+    assert(pos <= source_.size());
+    if (indexed_ < pos) { indexLines(); }
+    int row = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), pos) -
+              lineStarts_.begin();
+    int col = 1;
+    for (int i = lineStarts_[row - 1]; i < pos; i++) {
+        if (source_[i] == '\t') {
+            // col = ((col + 3) / 4) * 4 + 1; // bad
+            col += 1;
+            while (col % 8 != 1) { col += 1; } // good
+        } else {
+            col += 1;
+        }
     }
+    return {row, col};
 }
 
-APTnode MinicParser::tokenToNode(Token token, istream &input, bool &drop) {
+APTnode MinicParser::tokenToNode(int id, int pos, int len, bool &drop) {
     APTnode node;
-    node.attr.Set<string>("lval", token.lval);
-    node.attr.Set<int>("col_st", col_lex_);
-    node.attr.Set<int>("row_st", row_lex_);
+    node.attr.Set<string>("lval", source_.substr(pos, len));
+    node.attr.Set<int>("pos_st", pos);
+    node.attr.Set<int>("pos_ed", pos + len);
 
-    if (token.id == 43) { // 43: /\*
-        bool match1 = false, match2 = false;
-        while (input.good() && !input.eof() && !input.fail()) {
-            char c = input.get();
-            count(c);
-            match2 = match1 && (c == '/');
-            match1 = (c == '*');
-            if (match2) { break; }
-        }
-        if (!match2) {
-            throw parse_error(col_lex_, row_lex_,
-                              "unclosed block comment ‘/*’");
-        }
-        drop = true;
-    } else if (token.id == 42) { // 42: //[^\n\r]*
-        for (char c : token.lval) { count(c); }
+    if (id == 43 || id == 42) {
+        // 42: //[^\n\r]*
+        // 43: /\*, the rest of block comment already consumed
         drop = true;
-    } else if (token.id == 39 || token.id == 40) {
+    } else if (id == 39 || id == 40) {
         // 39: [ \t]+
         // 40: \n|\r\n
-        for (char c : token.lval) { count(c); }
         drop = true;
     } else { // normal token
-        for (char c : token.lval) { count(c); }
-        switch (token.id) {
+        switch (id) {
         case -1: // END_
             node.id = -1;
             break;
@@ -2107,51 +1700,81 @@ APTnode MinicParser::tokenToNode(Token token, istream &input, bool &drop) {
         case 45:
             node.id = syntax::FOR;
         default:
+            auto [row, col] = getLocation(pos);
             throw parse_error(
-                col_lex_, row_lex_,
-                to_string(fmt::format("unknown lexical token_id {} ‘{}’",
-                                      token.id, token.lval)));
+                col, row,
+                to_string(fmt::format("unknown lexical token_id {} ‘{}’", id,
+                                      source_.substr(pos, len))));
         }
         drop = false;
     }
-
-    node.attr.Set<int>("col_ed", col_lex_);
-    node.attr.Set<int>("row_ed", row_lex_);
     return node;
 }
 
-string MinicParser::getLocatedSource(int colSt, int rowSt, int colEd,
-                                     int rowEd) {
-    assert(std::tie(rowSt, colSt) <= std::tie(rowEd, colEd));
-    stringstream ss;
-    for (int row = rowSt; row <= rowEd; row++) {
-        string rowStr    = sourceLines_[row - 1].str();
-        int    currColSt = (row > rowSt) ? 0 : (colSt - 1);
-        int    currColEd = (row < rowSt) ? rowStr.size() : (colEd - 1);
-        ss << fmt::format("{}\n{}\033[33m{}{}\033[0m", rowStr,
-                          string(currColSt, ' '), "^",
-                          string(currColEd - currColSt - 1, '~'));
-        break; // only print one line
-    }
-    return ss.str();
+string MinicParser::getLocatedSource(int posSt, int posEd) const {
+    assert(posSt <= posEd);
+    auto [rowSt, colSt] = getLocation(posSt);
+    auto [rowEd, colEd] = getLocation(posEd);
+    int    lineSt = lineStarts_[rowSt - 1];
+    string rowStr = source_.substr(lineSt, source_.find('\n', lineSt) - lineSt);
+    // only print one line
+    int currColSt = colSt - 1;
+    int currColEd = (rowSt < rowEd) ? rowStr.size() : (colEd - 1);
+    return fmt::format("{}\n{}\033[33m{}{}\033[0m", rowStr,
+                       string(currColSt, ' '), "^",
+                       string(std::max(currColEd - currColSt - 1, 0), '~'));
 }
 
-void MinicParser::parseStep(istream &input) {
-    if (root_.get() != nullptr) { return; }
-    bool    drop  = false;
-    Token   token = lexicalParser_.parseStep(input);
-    APTnode node  = tokenToNode(token, input, drop);
+void MinicParser::parseToken(int id, int pos, int len) {
+    bool    drop = false;
+    APTnode node = tokenToNode(id, pos, len, drop);
 
     if (!drop) {
         nodes_.push_back(node);
         syntaxParser_.parseStep(node);
     }
 
-    if (token == END_TOKEN) { root_ = syntaxParser_.getAPT(); }
+    if (id == END_SYMBOL) { root_ = syntaxParser_.getAPT(); }
+}
+
+void MinicParser::parseStep(istream &input) {
+    if (root_.get() != nullptr) { return; }
+    Token token = lexicalParser_.parseStep(input);
+    int   pos   = source_.size();
+    source_ += token.lval;
+
+    if (token.id == 43) { // 43: /\*
+        bool match1 = false, match2 = false;
+        for (int c; !match2 && (c = input.get()) != EOF;) {
+            source_.push_back(c);
+            match2 = match1 && (c == '/');
+            match1 = (c == '*');
+        }
+        if (!match2) {
+            auto [row, col] = getLocation(source_.size());
+            throw parse_error(col, row, "unclosed block comment ‘/*’");
+        }
+    }
+    cursor_ = source_.size();
+    parseToken(token.id, pos, cursor_ - pos);
 }
 
 void MinicParser::parseAll(istream &input) {
-    while (this->root_.get() == nullptr) { parseStep(input); }
+    if (root_.get() != nullptr) { return; }
+    // read the rest at once, then lex in place
+    source_.append(std::istreambuf_iterator<char>(input), {});
+    while (root_.get() == nullptr) {
+        TokenView token = lexicalParser_.parseStep(source_, cursor_);
+        if (token.id == 43) { // 43: /\*
+            size_t ed = source_.find("*/", cursor_);
+            if (ed == string::npos) {
+                auto [row, col] = getLocation(source_.size());
+                throw parse_error(col, row, "unclosed block comment ‘/*’");
+            }
+            cursor_ = ed + 2;
+        }
+        parseToken(token.id, token.offset, cursor_ - token.offset);
+    }
 }
 
 shared_ptr<APTnode> MinicParser::getAptNode() const { return root_; }
@@ -2162,42 +1785,31 @@ MinicParser::MinicParser() : root_(nullptr) {
     // add location attributes for every APT node
 
     AptNodeFunc minicActionFunc = [this](APTnode &node) {
-        assert(node.attr.Has<int>("col_st"));
-        assert(node.attr.Has<int>("row_st"));
-        assert(node.attr.Has<int>("col_ed"));
-        assert(node.attr.Has<int>("row_ed"));
-        this->col_syn_ = node.attr.Get<int>("col_ed"); // bug!
-        this->row_syn_ = node.attr.Get<int>("row_ed"); // bug!
+        assert(node.attr.Has<int>("pos_st"));
+        assert(node.attr.Has<int>("pos_ed"));
+        this->pos_syn_ = node.attr.Get<int>("pos_ed"); // bug!
     };
     AptNodeFunc minicReduceFunc = [this](APTnode &node) {
         if (node.child.size() != 0) {
-            node.attr.RefN<int>("col_st") =
-                node.child.front().get()->attr.Get<int>("col_st");
-            node.attr.RefN<int>("row_st") =
-                node.child.front().get()->attr.Get<int>("row_st");
-            node.attr.RefN<int>("col_ed") =
-                node.child.back().get()->attr.Get<int>("col_ed");
-            node.attr.RefN<int>("row_ed") =
-                node.child.back().get()->attr.Get<int>("row_ed");
+            node.attr.RefN<int>("pos_st") =
+                node.child.front().get()->attr.Get<int>("pos_st");
+            node.attr.RefN<int>("pos_ed") =
+                node.child.back().get()->attr.Get<int>("pos_ed");
         } else {
             // empty production (local_decl <- )
-            node.attr.RefN<int>("col_st") = this->col_syn_;
-            node.attr.RefN<int>("row_st") = this->row_syn_;
-            node.attr.RefN<int>("col_ed") = this->col_syn_;
-            node.attr.RefN<int>("row_ed") = this->row_syn_;
+            node.attr.RefN<int>("pos_st") = this->pos_syn_;
+            node.attr.RefN<int>("pos_ed") = this->pos_syn_;
         }
     };
     AptNodeFunc minicErrorFunc = [this](APTnode &node) {
-        int  col_st = node.attr.Get<int>("col_st");
-        int  row_st = node.attr.Get<int>("row_st");
-        int  col_ed = node.attr.Get<int>("col_ed");
-        int  row_ed = node.attr.Get<int>("row_ed");
+        int  pos_st = node.attr.Get<int>("pos_st");
+        int  pos_ed = node.attr.Get<int>("pos_ed");
         auto lval   = node.attr.Get<string>("lval");
+        auto [row_st, col_st] = this->getLocation(pos_st);
 
-        auto errorMsg =
-            fmt::format("input:{}:{}: {}: {}\n{}", row_st, col_st,
-                        "\033[31merror\033[0m", "unexpected token",
-                        this->getLocatedSource(col_st, row_st, col_ed, row_ed));
+        auto errorMsg = fmt::format(
+            "input:{}:{}: {}: {}\n{}", row_st, col_st, "\033[31merror\033[0m",
+            "unexpected token", this->getLocatedSource(pos_st, pos_ed));
         // logger.error(errorMsg);
         throw parse_error(
             row_st, col_st,
@@ -2221,7 +1833,8 @@ MinicSyntaxParser::MinicSyntaxParser()
                    krill::minic::syntax::actionTable){};
 
 MinicLexicalParser::MinicLexicalParser()
-    : LexicalParser(krill::minic::lexical::dfa){};
+    : LexicalParser(krill::minic::lexical::dfa,
+                    krill::minic::lexical::keywordTable){};
 
 // SyntaxParser  minicSyntaxParser(minicGrammar,
 // krill::minic::syntax::actionTable); LexicalParser
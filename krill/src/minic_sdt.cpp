@@ -17,6 +17,13 @@ using std::make_shared, std::shared_ptr;
 
 namespace krill::minic {
 
+pair<int, int> SdtParser::locate(APTnode *node) const {
+    int pos = node->attr.Get<int>("pos_st");
+    // without the parser, only byte offset is known
+    if (parser_ == nullptr) { return {0, pos}; }
+    return parser_->getLocation(pos);
+}
+
 Var *SdtParser::assign_new_variable(const Var &base) {
     return ir_.variables.assign(base);
 }
@@ -140,8 +147,7 @@ Var *SdtParser::parse_var_decl(APTnode *node) {
             vector<int> init_list = parse_init_list(node_init);
 
             if (type.shape[0] != init_list.size()) {
-                int row = node_init->attr.Get<int>("row_st");
-                int col = node_init->attr.Get<int>("col_st");
+                auto [row, col] = locate(node_init);
                 throw parse_error(row, col,
                                   "unmatched size for intializer list");
             }
@@ -185,8 +191,7 @@ vector<Var *> SdtParser::parse_params(APTnode *node) {
         auto var = parse_var_decl(node);
 
         if (var->initVal.has_value()) {
-            int row = node->attr.Get<int>("row_st");
-            int col = node->attr.Get<int>("col_st");
+            auto [row, col] = locate(node);
             throw parse_error(row, col,
                               "cannot define initial value for parameters");
         }
@@ -207,8 +212,7 @@ Var *SdtParser::parse_ident_as_variable(APTnode *node) {
 
     // check exsistance of declaration
     if (var_ident == nullptr) {
-        int row = node->attr.Get<int>("row_st");
-        int col = node->attr.Get<int>("col_st");
+        auto [row, col] = locate(node);
         throw parse_error(row, col,
                           to_string(fmt::format(
                               "using undeclared variable ‘{}’", name_ident)));
@@ -225,8 +229,7 @@ Func *SdtParser::parse_ident_as_function(APTnode *node) {
 
     // check exsistance of declaration
     if (func_ident == nullptr) {
-        int row = node->attr.Get<int>("row_st");
-        int col = node->attr.Get<int>("col_st");
+        auto [row, col] = locate(node);
         throw parse_error(row, col,
                           to_string(fmt::format(
                               "using undeclared function ‘{}’", name_ident)));
@@ -242,8 +245,7 @@ pair<Var *, Code> SdtParser::parse_array_element(APTnode *node, Var *var_ident,
 
     // check array type
     if (var_ident->type.shape.size() < 1) {
-        int    row        = node->attr.Get<int>("row_st");
-        int    col        = node->attr.Get<int>("col_st");
+        auto [row, col] = locate(node);
         string name_ident = var_ident->type.str();
         throw parse_error(row, col,
                           to_string(fmt::format(
@@ -274,8 +276,7 @@ Code SdtParser::parse_function_call(APTnode *node, Func *func,
     auto extract_type = [](Var *var) { return var->type; };
     if (apply_map(func->params, extract_type) !=
         apply_map(var_args, extract_type)) {
-        int row = node->attr.Get<int>("row_st");
-        int col = node->attr.Get<int>("col_st");
+        auto [row, col] = locate(node);
         throw parse_error(
             row, col,
             to_string(fmt::format("input parameters' type are not match to "
@@ -446,8 +447,7 @@ void SdtParser::sdt_global_func_decl(APTnode *node) {
         auto prevDecl = find_function_by_name(funcname);
         if (prevDecl != nullptr) {
             if (prevDecl->type() != func->type()) {
-                int row = node->attr.Get<int>("row_st");
-                int col = node->attr.Get<int>("col_st");
+                auto [row, col] = locate(node);
                 throw parse_error(
                     row, col,
                     to_string(fmt::format(
@@ -456,8 +456,7 @@ void SdtParser::sdt_global_func_decl(APTnode *node) {
                         func_fullname(func), func_fullname(prevDecl))));
             }
             if (prevDecl->code.has_value() != false) {
-                int row = node->attr.Get<int>("row_st");
-                int col = node->attr.Get<int>("col_st");
+                auto [row, col] = locate(node);
                 throw parse_error(
                     row, col,
                     to_string(fmt::format("re-definition of function ‘{}’",
@@ -669,24 +668,21 @@ pair<Var *, Code> SdtParser::sdt_expr(APTnode *node) {
 
         // type check
         if (v_lhs->type != v_rhs->type) {
-            int row = node->attr.Get<int>("row_st");
-            int col = node->attr.Get<int>("col_st");
+            auto [row, col] = locate(node);
             throw parse_error(row, col, "operands are not in same type");
         }
 
         // cast int operands into bool
         if (is_bool_oprt(oprt)) {
             if (v_lhs->type.shape.size() != 0) {
-                int    row       = node->attr.Get<int>("row_st");
-                int    col       = node->attr.Get<int>("col_st");
+                auto [row, col] = locate(node);
                 string name_type = v_lhs->type.str();
                 throw parse_error(row, col,
                                   to_string(fmt::format(
                                       "try to cast {} into bool ", name_type)));
             }
             if (v_rhs->type.shape.size() != 0) {
-                int    row       = node->attr.Get<int>("row_st");
-                int    col       = node->attr.Get<int>("col_st");
+                auto [row, col] = locate(node);
                 string name_type = v_rhs->type.str();
                 throw parse_error(row, col,
                                   to_string(fmt::format(
@@ -882,8 +878,7 @@ pair<Var *, Code> SdtParser::sdt_expr(APTnode *node) {
         auto func = parse_ident_as_function(child[0].get());
         // check return type
         if (func->returns.size() != 1) {
-            int row = node->attr.Get<int>("row_st");
-            int col = node->attr.Get<int>("col_st");
+            auto [row, col] = locate(node);
             throw parse_error(
                 row, col,
                 to_string(fmt::format(
@@ -6,10 +6,15 @@
 #include "krill/utils.h"
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <set>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 #define ERR_LOG(...)                                                           \
@@ -56,71 +61,76 @@ const ActionTable actionTable = {
     {{1, 262}, {AC0, 9}},   {{1, 263}, {AC2, 10}},  {{2, -1}, {AC1, 19}},
     {{2, 40}, {AC1, 19}},   {{2, 41}, {AC1, 19}},   {{2, 42}, {AC1, 19}},
     {{2, 43}, {AC1, 19}},   {{2, 46}, {AC1, 19}},   {{2, 63}, {AC1, 19}},
-    {{2, 91}, {AC1, 19}},   {{2, 124}, {AC1, 19}},  {{2, 262}, {AC1, 19}},
-    {{3, 94}, {AC0, 12}},   {{3, 262}, {AC0, 13}},  {{3, 264}, {AC2, 14}},
-    {{3, 265}, {AC2, 15}},  {{4, -1}, {AC3, 0}},    {{4, 124}, {AC0, 16}},
-    {{5, -1}, {AC1, 2}},    {{5, 40}, {AC0, 1}},    {{5, 41}, {AC1, 2}},
-    {{5, 46}, {AC0, 2}},    {{5, 91}, {AC0, 3}},    {{5, 124}, {AC1, 2}},
-    {{5, 259}, {AC2, 17}},  {{5, 260}, {AC2, 7}},   {{5, 261}, {AC2, 8}},
-    {{5, 262}, {AC0, 9}},   {{5, 263}, {AC2, 10}},  {{6, -1}, {AC1, 4}},
-    {{6, 40}, {AC1, 4}},    {{6, 41}, {AC1, 4}},    {{6, 46}, {AC1, 4}},
-    {{6, 91}, {AC1, 4}},    {{6, 124}, {AC1, 4}},   {{6, 262}, {AC1, 4}},
-    {{7, -1}, {AC1, 5}},    {{7, 40}, {AC1, 5}},    {{7, 41}, {AC1, 5}},
-    {{7, 46}, {AC1, 5}},    {{7, 91}, {AC1, 5}},    {{7, 124}, {AC1, 5}},
-    {{7, 262}, {AC1, 5}},   {{8, -1}, {AC1, 6}},    {{8, 40}, {AC1, 6}},
-    {{8, 41}, {AC1, 6}},    {{8, 42}, {AC0, 18}},   {{8, 43}, {AC0, 19}},
-    {{8, 46}, {AC1, 6}},    {{8, 63}, {AC0, 20}},   {{8, 91}, {AC1, 6}},
-    {{8, 124}, {AC1, 6}},   {{8, 262}, {AC1, 6}},   {{9, -1}, {AC1, 11}},
-    {{9, 40}, {AC1, 11}},   {{9, 41}, {AC1, 11}},   {{9, 42}, {AC1, 11}},
-    {{9, 43}, {AC1, 11}},   {{9, 46}, {AC1, 11}},   {{9, 63}, {AC1, 11}},
-    {{9, 91}, {AC1, 11}},   {{9, 124}, {AC1, 11}},  {{9, 262}, {AC1, 11}},
+    {{2, 91}, {AC1, 19}},   {{2, 123}, {AC1, 19}},  {{2, 124}, {AC1, 19}},
+    {{2, 262}, {AC1, 19}},  {{3, 94}, {AC0, 12}},   {{3, 262}, {AC0, 13}},
+    {{3, 264}, {AC2, 14}},  {{3, 265}, {AC2, 15}},  {{4, -1}, {AC3, 0}},
+    {{4, 124}, {AC0, 16}},  {{5, -1}, {AC1, 2}},    {{5, 40}, {AC0, 1}},
+    {{5, 41}, {AC1, 2}},    {{5, 46}, {AC0, 2}},    {{5, 91}, {AC0, 3}},
+    {{5, 124}, {AC1, 2}},   {{5, 259}, {AC2, 17}},  {{5, 260}, {AC2, 7}},
+    {{5, 261}, {AC2, 8}},   {{5, 262}, {AC0, 9}},   {{5, 263}, {AC2, 10}},
+    {{6, -1}, {AC1, 4}},    {{6, 40}, {AC1, 4}},    {{6, 41}, {AC1, 4}},
+    {{6, 46}, {AC1, 4}},    {{6, 91}, {AC1, 4}},    {{6, 124}, {AC1, 4}},
+    {{6, 262}, {AC1, 4}},   {{7, -1}, {AC1, 5}},    {{7, 40}, {AC1, 5}},
+    {{7, 41}, {AC1, 5}},    {{7, 46}, {AC1, 5}},    {{7, 91}, {AC1, 5}},
+    {{7, 124}, {AC1, 5}},   {{7, 262}, {AC1, 5}},   {{8, -1}, {AC1, 6}},
+    {{8, 40}, {AC1, 6}},    {{8, 41}, {AC1, 6}},    {{8, 42}, {AC0, 18}},
+    {{8, 43}, {AC0, 19}},   {{8, 46}, {AC1, 6}},    {{8, 63}, {AC0, 20}},
+    {{8, 91}, {AC1, 6}},    {{8, 123}, {AC0, 21}},  {{8, 124}, {AC1, 6}},
+    {{8, 262}, {AC1, 6}},   {{9, -1}, {AC1, 11}},   {{9, 40}, {AC1, 11}},
+    {{9, 41}, {AC1, 11}},   {{9, 42}, {AC1, 11}},   {{9, 43}, {AC1, 11}},
+    {{9, 46}, {AC1, 11}},   {{9, 63}, {AC1, 11}},   {{9, 91}, {AC1, 11}},
+    {{9, 123}, {AC1, 11}},  {{9, 124}, {AC1, 11}},  {{9, 262}, {AC1, 11}},
     {{10, -1}, {AC1, 12}},  {{10, 40}, {AC1, 12}},  {{10, 41}, {AC1, 12}},
     {{10, 42}, {AC1, 12}},  {{10, 43}, {AC1, 12}},  {{10, 46}, {AC1, 12}},
-    {{10, 63}, {AC1, 12}},  {{10, 91}, {AC1, 12}},  {{10, 124}, {AC1, 12}},
-    {{10, 262}, {AC1, 12}}, {{11, 41}, {AC0, 21}},  {{11, 124}, {AC0, 16}},
-    {{12, 262}, {AC0, 13}}, {{12, 264}, {AC2, 22}}, {{12, 265}, {AC2, 15}},
-    {{13, 45}, {AC0, 23}},  {{13, 93}, {AC1, 18}},  {{13, 262}, {AC1, 18}},
-    {{14, 93}, {AC0, 24}},  {{14, 262}, {AC0, 13}}, {{14, 265}, {AC2, 25}},
-    {{15, 93}, {AC1, 16}},  {{15, 262}, {AC1, 16}}, {{16, 40}, {AC0, 1}},
-    {{16, 46}, {AC0, 2}},   {{16, 91}, {AC0, 3}},   {{16, 258}, {AC2, 26}},
-    {{16, 259}, {AC2, 6}},  {{16, 260}, {AC2, 7}},  {{16, 261}, {AC2, 8}},
-    {{16, 262}, {AC0, 9}},  {{16, 263}, {AC2, 10}}, {{17, -1}, {AC1, 3}},
-    {{17, 40}, {AC1, 3}},   {{17, 41}, {AC1, 3}},   {{17, 46}, {AC1, 3}},
-    {{17, 91}, {AC1, 3}},   {{17, 124}, {AC1, 3}},  {{17, 262}, {AC1, 3}},
-    {{18, -1}, {AC1, 8}},   {{18, 40}, {AC1, 8}},   {{18, 41}, {AC1, 8}},
-    {{18, 46}, {AC1, 8}},   {{18, 91}, {AC1, 8}},   {{18, 124}, {AC1, 8}},
-    {{18, 262}, {AC1, 8}},  {{19, -1}, {AC1, 7}},   {{19, 40}, {AC1, 7}},
-    {{19, 41}, {AC1, 7}},   {{19, 46}, {AC1, 7}},   {{19, 91}, {AC1, 7}},
-    {{19, 124}, {AC1, 7}},  {{19, 262}, {AC1, 7}},  {{20, -1}, {AC1, 9}},
-    {{20, 40}, {AC1, 9}},   {{20, 41}, {AC1, 9}},   {{20, 46}, {AC1, 9}},
-    {{20, 91}, {AC1, 9}},   {{20, 124}, {AC1, 9}},  {{20, 262}, {AC1, 9}},
-    {{21, -1}, {AC1, 10}},  {{21, 40}, {AC1, 10}},  {{21, 41}, {AC1, 10}},
-    {{21, 42}, {AC1, 10}},  {{21, 43}, {AC1, 10}},  {{21, 46}, {AC1, 10}},
-    {{21, 63}, {AC1, 10}},  {{21, 91}, {AC1, 10}},  {{21, 124}, {AC1, 10}},
-    {{21, 262}, {AC1, 10}}, {{22, 93}, {AC0, 27}},  {{22, 262}, {AC0, 13}},
-    {{22, 265}, {AC2, 25}}, {{23, 262}, {AC0, 28}}, {{24, -1}, {AC1, 13}},
-    {{24, 40}, {AC1, 13}},  {{24, 41}, {AC1, 13}},  {{24, 42}, {AC1, 13}},
-    {{24, 43}, {AC1, 13}},  {{24, 46}, {AC1, 13}},  {{24, 63}, {AC1, 13}},
-    {{24, 91}, {AC1, 13}},  {{24, 124}, {AC1, 13}}, {{24, 262}, {AC1, 13}},
-    {{25, 93}, {AC1, 15}},  {{25, 262}, {AC1, 15}}, {{26, -1}, {AC1, 1}},
-    {{26, 40}, {AC0, 1}},   {{26, 41}, {AC1, 1}},   {{26, 46}, {AC0, 2}},
-    {{26, 91}, {AC0, 3}},   {{26, 124}, {AC1, 1}},  {{26, 259}, {AC2, 17}},
-    {{26, 260}, {AC2, 7}},  {{26, 261}, {AC2, 8}},  {{26, 262}, {AC0, 9}},
-    {{26, 263}, {AC2, 10}}, {{27, -1}, {AC1, 14}},  {{27, 40}, {AC1, 14}},
-    {{27, 41}, {AC1, 14}},  {{27, 42}, {AC1, 14}},  {{27, 43}, {AC1, 14}},
-    {{27, 46}, {AC1, 14}},  {{27, 63}, {AC1, 14}},  {{27, 91}, {AC1, 14}},
-    {{27, 124}, {AC1, 14}}, {{27, 262}, {AC1, 14}}, {{28, 93}, {AC1, 17}},
-    {{28, 262}, {AC1, 17}},
+    {{10, 63}, {AC1, 12}},  {{10, 91}, {AC1, 12}},  {{10, 123}, {AC1, 12}},
+    {{10, 124}, {AC1, 12}}, {{10, 262}, {AC1, 12}}, {{11, 41}, {AC0, 22}},
+    {{11, 124}, {AC0, 16}}, {{12, 262}, {AC0, 13}}, {{12, 264}, {AC2, 23}},
+    {{12, 265}, {AC2, 15}}, {{13, 45}, {AC0, 24}},  {{13, 93}, {AC1, 18}},
+    {{13, 262}, {AC1, 18}}, {{14, 93}, {AC0, 25}},  {{14, 262}, {AC0, 13}},
+    {{14, 265}, {AC2, 26}}, {{15, 93}, {AC1, 16}},  {{15, 262}, {AC1, 16}},
+    {{16, 40}, {AC0, 1}},   {{16, 46}, {AC0, 2}},   {{16, 91}, {AC0, 3}},
+    {{16, 258}, {AC2, 27}}, {{16, 259}, {AC2, 6}},  {{16, 260}, {AC2, 7}},
+    {{16, 261}, {AC2, 8}},  {{16, 262}, {AC0, 9}},  {{16, 263}, {AC2, 10}},
+    {{17, -1}, {AC1, 3}},   {{17, 40}, {AC1, 3}},   {{17, 41}, {AC1, 3}},
+    {{17, 46}, {AC1, 3}},   {{17, 91}, {AC1, 3}},   {{17, 124}, {AC1, 3}},
+    {{17, 262}, {AC1, 3}},  {{18, -1}, {AC1, 8}},   {{18, 40}, {AC1, 8}},
+    {{18, 41}, {AC1, 8}},   {{18, 46}, {AC1, 8}},   {{18, 91}, {AC1, 8}},
+    {{18, 124}, {AC1, 8}},  {{18, 262}, {AC1, 8}},  {{19, -1}, {AC1, 7}},
+    {{19, 40}, {AC1, 7}},   {{19, 41}, {AC1, 7}},   {{19, 46}, {AC1, 7}},
+    {{19, 91}, {AC1, 7}},   {{19, 124}, {AC1, 7}},  {{19, 262}, {AC1, 7}},
+    {{20, -1}, {AC1, 9}},   {{20, 40}, {AC1, 9}},   {{20, 41}, {AC1, 9}},
+    {{20, 46}, {AC1, 9}},   {{20, 91}, {AC1, 9}},   {{20, 124}, {AC1, 9}},
+    {{20, 262}, {AC1, 9}},  {{21, -1}, {AC1, 20}},  {{21, 40}, {AC1, 20}},
+    {{21, 41}, {AC1, 20}},  {{21, 46}, {AC1, 20}},  {{21, 91}, {AC1, 20}},
+    {{21, 124}, {AC1, 20}}, {{21, 262}, {AC1, 20}}, {{22, -1}, {AC1, 10}},
+    {{22, 40}, {AC1, 10}},  {{22, 41}, {AC1, 10}},  {{22, 42}, {AC1, 10}},
+    {{22, 43}, {AC1, 10}},  {{22, 46}, {AC1, 10}},  {{22, 63}, {AC1, 10}},
+    {{22, 91}, {AC1, 10}},  {{22, 123}, {AC1, 10}}, {{22, 124}, {AC1, 10}},
+    {{22, 262}, {AC1, 10}}, {{23, 93}, {AC0, 28}},  {{23, 262}, {AC0, 13}},
+    {{23, 265}, {AC2, 26}}, {{24, 262}, {AC0, 29}}, {{25, -1}, {AC1, 13}},
+    {{25, 40}, {AC1, 13}},  {{25, 41}, {AC1, 13}},  {{25, 42}, {AC1, 13}},
+    {{25, 43}, {AC1, 13}},  {{25, 46}, {AC1, 13}},  {{25, 63}, {AC1, 13}},
+    {{25, 91}, {AC1, 13}},  {{25, 123}, {AC1, 13}}, {{25, 124}, {AC1, 13}},
+    {{25, 262}, {AC1, 13}}, {{26, 93}, {AC1, 15}},  {{26, 262}, {AC1, 15}},
+    {{27, -1}, {AC1, 1}},   {{27, 40}, {AC0, 1}},   {{27, 41}, {AC1, 1}},
+    {{27, 46}, {AC0, 2}},   {{27, 91}, {AC0, 3}},   {{27, 124}, {AC1, 1}},
+    {{27, 259}, {AC2, 17}}, {{27, 260}, {AC2, 7}},  {{27, 261}, {AC2, 8}},
+    {{27, 262}, {AC0, 9}},  {{27, 263}, {AC2, 10}}, {{28, -1}, {AC1, 14}},
+    {{28, 40}, {AC1, 14}},  {{28, 41}, {AC1, 14}},  {{28, 42}, {AC1, 14}},
+    {{28, 43}, {AC1, 14}},  {{28, 46}, {AC1, 14}},  {{28, 63}, {AC1, 14}},
+    {{28, 91}, {AC1, 14}},  {{28, 123}, {AC1, 14}}, {{28, 124}, {AC1, 14}},
+    {{28, 262}, {AC1, 14}}, {{29, 93}, {AC1, 17}},  {{29, 262}, {AC1, 17}},
 };
 
 const map<int, string> symbolNames = {
-    {-1, "END_"},      {40, "'('"},       {41, "')'"},   {42, "'*'"},
-    {43, "'+'"},       {45, "'-'"},       {46, "'.'"},   {63, "'?'"},
-    {91, "'['"},       {93, "']'"},       {94, "'^'"},   {124, "'|'"},
-    {256, "RegEx"},    {257, "Parallel"}, {258, "Seq"},  {259, "Item"},
-    {260, "Closure"},  {261, "Atom"},     {262, "Char"}, {263, "Range"},
-    {264, "RangeSeq"}, {265, "RangeItem"}};
-const set<int> terminalSet = {40, 41, 42, 43, 45, 46, 63, 91, 93, 94, 124, 262};
+    {-1, "END_"},       {40, "'('"},       {41, "')'"},      {42, "'*'"},
+    {43, "'+'"},        {45, "'-'"},       {46, "'.'"},      {63, "'?'"},
+    {91, "'['"},        {93, "']'"},       {94, "'^'"},      {123, "'{'"},
+    {124, "'|'"},       {256, "RegEx"},    {257, "Parallel"}, {258, "Seq"},
+    {259, "Item"},      {260, "Closure"},  {261, "Atom"},     {262, "Char"},
+    {263, "Range"},     {264, "RangeSeq"}, {265, "RangeItem"}};
+const set<int> terminalSet = {40, 41, 42, 43,  45,  46, 63,
+                              91, 93, 94, 123, 124, 262};
 const set<int> nonterminalSet = {256, 257, 258, 259, 260, 261, 263, 264, 265};
 
 const vector<Prod> prods = {
@@ -144,11 +154,34 @@ const vector<Prod> prods = {
     /* 17: RangeItem -> Char '-' Char */ {RangeItem, {Char, '-', Char}},
     /* 18: RangeItem -> Char */ {RangeItem, {Char}},
     /* 19: Atom -> '.' */ {Atom, {'.'}},
+    /* 20: Closure -> Atom '{' */ {Closure, {Atom, '{'}},
 };
 
 const Grammar RegexParser::grammar_ =
     Grammar(terminalSet, nonterminalSet, prods, symbolNames);
 
+// length of counted repetition {m}, {m,} or {m,n} at regex[i], 0 if not
+static int getRepeatLength(const string &regex, int i) {
+    if (regex[i] != '{') { return 0; }
+    int j = i + 1, numDigits = 0, numCommas = 0;
+    for (; j < regex.size() && regex[j] != '}'; j++) {
+        if (isdigit((unsigned char) regex[j])) {
+            numDigits += (numCommas == 0);
+        } else if (regex[j] != ',' || numCommas++ > 0) {
+            return 0;
+        }
+    }
+    return (j < regex.size() && numDigits > 0) ? j - i + 1 : 0;
+}
+
+// {m}, {m,} or {m,n} => {m, n}, n = -1 if unbounded
+static pair<int, int> getRepeatRange(const string &lval) {
+    int m = 0, n = 0;
+    int numRead = sscanf(lval.c_str(), "{%d,%d}", &m, &n);
+    if (numRead == 1) { n = (lval.find(',') == string::npos) ? m : -1; }
+    return {m, n};
+}
+
 // RegEx String => tokens
 void RegexParser::lexicalParse() {
     static const map<char, int> lexMap = {
@@ -163,7 +196,8 @@ void RegexParser::lexicalParse() {
     tokens_       = {};
     int  pos      = 0;
     bool isEscape = false;
-    for (char c : regex_) {
+    for (int i = 0; i < regex_.size(); i++) {
+        char c = regex_[i];
         if (isEscape) {
             if (escapeLexMap.count(c) != 0) {
                 tokens_.push_back({.id   = Char,
@@ -182,6 +216,16 @@ void RegexParser::lexicalParse() {
             continue;
         } else if (c == '\\') {
             isEscape = true;
+        } else if (int len = getRepeatLength(regex_, i); len > 0) {
+            // counted repetition {m}, {m,} or {m,n} as one token,
+            // otherwise '{' is a plain char
+            tokens_.push_back({.id   = '{',
+                               .lval = regex_.substr(i, len),
+                               .rval = c,
+                               .st   = pos,
+                               .ed   = pos + len - 1});
+            i += len - 1;
+            pos += len - 1;
         } else {
             int id_ = (lexMap.count(c) != 0) ? lexMap.at(c) : Char;
             tokens_.push_back({.id   = id_,
@@ -238,13 +282,16 @@ void RegexParser::syntaxParse() {
                 // just pass the id and lval into node
                 Node nextNode;
                 nextNode = Node({
-                    .id    = tokens_[i].id,
-                    .lval  = tokens_[i].lval,
-                    .rval  = tokens_[i].rval,
-                    .nfaSt = -1,
-                    .nfaEd = -1,
-                    .st    = tokens_[i].st,
-                    .ed    = tokens_[i].ed,
+                    .id        = tokens_[i].id,
+                    .lval      = tokens_[i].lval,
+                    .rval      = tokens_[i].rval,
+                    .nfaSt     = -1,
+                    .nfaEd     = -1,
+                    .st        = tokens_[i].st,
+                    .ed        = tokens_[i].ed,
+                    .nfaNodeSt = numNfaNodes,
+                    .nfaEdgeSt = (int) nfaEdges.size(),
+                    .posSt     = (int) posSymbols_.size(),
                 });
                 nodes_.push(nextNode);
                 i++;
@@ -329,40 +376,53 @@ void RegexParser::syntaxParse() {
                         break;
                     }
                     case 7: { // Closure -> Atom '+'
+                        // fresh start and end, or the loop leaks into
+                        // an enclosing '?' or '*' sharing them
+                        int from = numNfaNodes++;
+                        int to   = numNfaNodes++;
+                        int st = child[0].nfaSt, ed = child[0].nfaEd;
+                        nfaEdges.push_back({EMPTY_SYMBOL, from, st});
+                        nfaEdges.push_back({EMPTY_SYMBOL, ed, to});
                         nfaEdges.push_back({.symbol = EMPTY_SYMBOL,
                                             .from   = child[0].nfaEd,
                                             .to     = child[0].nfaSt});
                         nextNode = Node({.id    = prods.at(action.tgt).symbol,
                                          .lval  = child[0].lval + "+",
-                                         .nfaSt = child[0].nfaSt,
-                                         .nfaEd = child[0].nfaEd,
+                                         .nfaSt = from,
+                                         .nfaEd = to,
                                          .st    = child[0].st,
                                          .ed    = child[1].ed});
                         break;
                     }
                     case 8: { // Closure -> Atom '*'
-                        nfaEdges.push_back({.symbol = EMPTY_SYMBOL,
-                                            .from   = child[0].nfaSt,
-                                            .to     = child[0].nfaEd});
+                        int from = numNfaNodes++;
+                        int to   = numNfaNodes++;
+                        int st = child[0].nfaSt, ed = child[0].nfaEd;
+                        nfaEdges.push_back({EMPTY_SYMBOL, from, st});
+                        nfaEdges.push_back({EMPTY_SYMBOL, ed, to});
+                        nfaEdges.push_back({EMPTY_SYMBOL, from, to});
                         nfaEdges.push_back({.symbol = EMPTY_SYMBOL,
                                             .from   = child[0].nfaEd,
                                             .to     = child[0].nfaSt});
                         nextNode = Node({.id    = prods.at(action.tgt).symbol,
                                          .lval  = child[0].lval + "*",
-                                         .nfaSt = child[0].nfaSt,
-                                         .nfaEd = child[0].nfaEd,
+                                         .nfaSt = from,
+                                         .nfaEd = to,
                                          .st    = child[0].st,
                                          .ed    = child[1].ed});
                         break;
                     }
                     case 9: { // Closure -> Atom '?'
-                        nfaEdges.push_back({.symbol = EMPTY_SYMBOL,
-                                            .from   = child[0].nfaSt,
-                                            .to     = child[0].nfaEd});
+                        int from = numNfaNodes++;
+                        int to   = numNfaNodes++;
+                        int st = child[0].nfaSt, ed = child[0].nfaEd;
+                        nfaEdges.push_back({EMPTY_SYMBOL, from, st});
+                        nfaEdges.push_back({EMPTY_SYMBOL, ed, to});
+                        nfaEdges.push_back({EMPTY_SYMBOL, from, to});
                         nextNode = Node({.id    = prods.at(action.tgt).symbol,
                                          .lval  = child[0].lval + "?",
-                                         .nfaSt = child[0].nfaSt,
-                                         .nfaEd = child[0].nfaEd,
+                                         .nfaSt = from,
+                                         .nfaEd = to,
                                          .st    = child[0].st,
                                          .ed    = child[1].ed});
                         break;
@@ -504,11 +564,71 @@ void RegexParser::syntaxParse() {
                                          .ed    = child[0].ed});
                         break;
                     }
+                    case 20: { // Closure -> Atom '{'
+                        auto [m, n] = getRepeatRange(child[1].lval);
+                        if (n >= 0 && m > n) {
+                            ERR_LOG("Regex Parsing Error: bad repetition "
+                                    "‘{}’ in ‘{}’",
+                                    child[1].lval, regex_);
+                        }
+                        // copy the NFA of atom by shifting its nodes,
+                        // instead of building it again for each
+                        int nodeSt = child[0].nfaNodeSt;
+                        int nodeEd = numNfaNodes;
+                        int edgeSt = child[0].nfaEdgeSt;
+                        int edgeEd = nfaEdges.size();
+                        int k      = (n < 0) ? std::max(m, 1) : n;
+                        vector<pair<int, int>> copies;
+                        copies.push_back({child[0].nfaSt, child[0].nfaEd});
+                        for (int j = 1; j < k; j++) {
+                            int shift = numNfaNodes - nodeSt;
+                            for (int e = edgeSt; e < edgeEd; e++) {
+                                Edge edge = nfaEdges[e];
+                                nfaEdges.push_back({edge.symbol,
+                                                    edge.from + shift,
+                                                    edge.to + shift});
+                            }
+                            numNfaNodes += nodeEd - nodeSt;
+                            copies.push_back({child[0].nfaSt + shift,
+                                              child[0].nfaEd + shift});
+                        }
+                        // A{2,4} = AA(A(A)?)?, A{2,} = AA+
+                        int from = numNfaNodes++;
+                        int to   = numNfaNodes++;
+                        int cur  = from;
+                        for (int j = 0; j < k; j++) {
+                            if (j >= m) {
+                                nfaEdges.push_back({EMPTY_SYMBOL, cur, to});
+                            }
+                            nfaEdges.push_back(
+                                {EMPTY_SYMBOL, cur, copies[j].first});
+                            cur = copies[j].second;
+                        }
+                        nfaEdges.push_back({EMPTY_SYMBOL, cur, to});
+                        if (n < 0) {
+                            nfaEdges.push_back({EMPTY_SYMBOL,
+                                                copies[k - 1].second,
+                                                copies[k - 1].first});
+                        }
+                        nextNode = Node({.id    = prods.at(action.tgt).symbol,
+                                         .lval  = child[0].lval + child[1].lval,
+                                         .nfaSt = from,
+                                         .nfaEd = to,
+                                         .st    = child[0].st,
+                                         .ed    = child[1].ed});
+                        break;
+                    }
                     default: {
                         assert(false);
                         break;
                     }
                 }
+                nextNode.nfaNodeSt = child[0].nfaNodeSt;
+                nextNode.nfaEdgeSt = child[0].nfaEdgeSt;
+                nextNode.posSt     = child[0].posSt;
+
+                reducePositions(action.tgt, child, nextNode);
+                reduceLiterals(action.tgt, child, nextNode);
 
                 // fmt::print("[{} ‘{}’]", symbolNames.at(nextNode.id),
                 //            nextNode.lval);
@@ -532,6 +652,257 @@ void RegexParser::syntaxParse() {
         */
 }
 
+// union of sorted positions
+static vector<int> getUnion(const vector<int> &a, const vector<int> &b) {
+    vector<int> res;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::back_inserter(res));
+    return res;
+}
+
+// RegEx syntax tree => nullable, firstpos, lastpos, followpos
+// computed bottom-up along with the NFA, see Aho-Sethi-Ullman 3.9
+void RegexParser::reducePositions(int prodIdx, const vector<Node> &child,
+                                  Node &node) {
+    auto addFollowpos = [this](const vector<int> &from,
+                               const vector<int> &to) {
+        for (int pos : from) {
+            followpos_[pos] = getUnion(followpos_[pos], to);
+        }
+    };
+    auto newPosition = [this, &node](vector<int> symbols) {
+        int pos = posSymbols_.size();
+        posSymbols_.push_back(symbols);
+        followpos_.push_back({});
+        node.nullable = false;
+        node.firstpos = node.lastpos = {pos};
+    };
+
+    switch (prodIdx) {
+        case 0:   // RegEx -> Parallel
+        case 2:   // Parallel -> Seq
+        case 4:   // Seq -> Item
+        case 5:   // Item -> Closure
+        case 6:   // Item -> Atom
+        case 12:  // Atom -> Range
+        case 10: { // Atom -> '(' Parallel ')'
+            const Node &inner = child[prodIdx == 10 ? 1 : 0];
+            node.nullable     = inner.nullable;
+            node.firstpos     = inner.firstpos;
+            node.lastpos      = inner.lastpos;
+            break;
+        }
+        case 1: { // Parallel -> Parallel '|' Seq
+            node.nullable = child[0].nullable || child[2].nullable;
+            node.firstpos = getUnion(child[0].firstpos, child[2].firstpos);
+            node.lastpos  = getUnion(child[0].lastpos, child[2].lastpos);
+            break;
+        }
+        case 3: { // Seq -> Seq Item
+            node.nullable = child[0].nullable && child[1].nullable;
+            node.firstpos = child[0].nullable
+                                ? getUnion(child[0].firstpos, child[1].firstpos)
+                                : child[0].firstpos;
+            node.lastpos  = child[1].nullable
+                                ? getUnion(child[0].lastpos, child[1].lastpos)
+                                : child[1].lastpos;
+            addFollowpos(child[0].lastpos, child[1].firstpos);
+            break;
+        }
+        case 7:   // Closure -> Atom '+'
+        case 8:   // Closure -> Atom '*'
+        case 9: { // Closure -> Atom '?'
+            node.nullable = (prodIdx == 7) ? child[0].nullable : true;
+            node.firstpos = child[0].firstpos;
+            node.lastpos  = child[0].lastpos;
+            if (prodIdx != 9) {
+                addFollowpos(child[0].lastpos, child[0].firstpos);
+            }
+            break;
+        }
+        case 20: { // Closure -> Atom '{'
+            auto [m, n] = getRepeatRange(child[1].lval);
+            int  k      = (n < 0) ? std::max(m, 1) : n;
+            // copies of positions of atom, shifted, before any followpos
+            // is added between them
+            int posSt = child[0].posSt, posEd = posSymbols_.size();
+            vector<Node> copies(k, child[0]);
+            for (int j = 1; j < k; j++) {
+                int shift = posSymbols_.size() - posSt;
+                for (int pos = posSt; pos < posEd; pos++) {
+                    vector<int> symbols = posSymbols_[pos];
+                    vector<int> follow  = followpos_[pos];
+                    for (int &to : follow) { to += shift; }
+                    posSymbols_.push_back(std::move(symbols));
+                    followpos_.push_back(std::move(follow));
+                }
+                for (int &pos : copies[j].firstpos) { pos += shift; }
+                for (int &pos : copies[j].lastpos) { pos += shift; }
+            }
+            // then concatenated as '?' or '+' of Seq does, from the end
+            Node tail;
+            tail.nullable = true;
+            if (n < 0) {
+                addFollowpos(copies[k - 1].lastpos, copies[k - 1].firstpos);
+                tail = copies[k - 1];
+                tail.nullable |= (m == 0);
+                k--;
+            }
+            for (int j = k - 1; j >= 0; j--) {
+                const Node &a = copies[j];
+                addFollowpos(a.lastpos, tail.firstpos);
+                tail.firstpos = a.nullable ? getUnion(a.firstpos, tail.firstpos)
+                                           : a.firstpos;
+                tail.lastpos  = tail.nullable ? getUnion(a.lastpos, tail.lastpos)
+                                              : tail.lastpos;
+                tail.nullable = (a.nullable && tail.nullable) || j >= m;
+            }
+            node.nullable = tail.nullable;
+            node.firstpos = tail.firstpos;
+            node.lastpos  = tail.lastpos;
+            break;
+        }
+        case 11: { // Atom -> Char
+            newPosition({child[0].rval});
+            break;
+        }
+        case 13: { // Range -> '[' RangeSeq ']'
+            vector<int> symbols;
+            for (char symbol : child[1].rangeChars) {
+                symbols.push_back(symbol);
+            }
+            std::sort(symbols.begin(), symbols.end());
+            newPosition(symbols);
+            break;
+        }
+        case 14: { // Range -> '[' '^' RangeSeq ']'
+            vector<int> symbols;
+            for (int c = 1; c <= 127; c++) {
+                if (child[2].rangeChars.count((char) c) == 0) {
+                    symbols.push_back(c);
+                }
+            }
+            newPosition(symbols);
+            break;
+        }
+        case 19: { // Atom -> '.'
+            vector<int> symbols;
+            for (int c = 1; c <= 127; c++) {
+                if (c != '\r' && c != '\n') { symbols.push_back(c); }
+            }
+            newPosition(symbols);
+            break;
+        }
+        default: { // RangeSeq, RangeItem: no position
+            break;
+        }
+    }
+}
+
+// keep the longer required literal (bounded offset if tie)
+static void addRequired(Literals &lits, const string &required, int offset) {
+    if (required.size() > lits.required.size() ||
+        (required.size() == lits.required.size() && lits.reqOffset < 0 &&
+         offset >= 0)) {
+        lits.required  = required;
+        lits.reqOffset = offset;
+    }
+}
+
+// RegEx syntax tree => literals every match has, computed bottom-up
+void RegexParser::reduceLiterals(int prodIdx, const vector<Node> &child,
+                                 Node &node) {
+    Literals &lits = node.literals;
+    switch (prodIdx) {
+        case 0:   // RegEx -> Parallel
+        case 2:   // Parallel -> Seq
+        case 4:   // Seq -> Item
+        case 5:   // Item -> Closure
+        case 6:   // Item -> Atom
+        case 12:  // Atom -> Range
+        case 10: { // Atom -> '(' Parallel ')'
+            lits = child[prodIdx == 10 ? 1 : 0].literals;
+            return;
+        }
+        case 1: { // Parallel -> Parallel '|' Seq
+            const Literals &a = child[0].literals, &b = child[2].literals;
+            lits.isExact = a.isExact && b.isExact && a.prefix == b.prefix;
+            int i = 0;
+            while (i < a.prefix.size() && i < b.prefix.size() &&
+                   a.prefix[i] == b.prefix[i]) {
+                i++;
+            }
+            lits.prefix = a.prefix.substr(0, i);
+            int j = 0;
+            while (j < a.suffix.size() && j < b.suffix.size() &&
+                   a.suffix[a.suffix.size() - 1 - j] ==
+                       b.suffix[b.suffix.size() - 1 - j]) {
+                j++;
+            }
+            lits.suffix = a.suffix.substr(a.suffix.size() - j);
+            lits.maxLen = (a.maxLen < 0 || b.maxLen < 0)
+                              ? -1
+                              : std::max(a.maxLen, b.maxLen);
+            break;
+        }
+        case 3: { // Seq -> Seq Item
+            const Literals &a = child[0].literals, &b = child[1].literals;
+            lits.isExact = a.isExact && b.isExact;
+            lits.prefix  = a.isExact ? a.prefix + b.prefix : a.prefix;
+            lits.suffix  = b.isExact ? a.suffix + b.suffix : b.suffix;
+            lits.maxLen  = (a.maxLen < 0 || b.maxLen < 0) ? -1
+                                                          : a.maxLen + b.maxLen;
+            addRequired(lits, a.required, a.reqOffset);
+            addRequired(lits, b.required,
+                        (a.maxLen < 0 || b.reqOffset < 0)
+                            ? -1
+                            : a.maxLen + b.reqOffset);
+            addRequired(lits, a.suffix + b.prefix,
+                        a.maxLen < 0 ? -1 : a.maxLen - (int) a.suffix.size());
+            break;
+        }
+        case 7: { // Closure -> Atom '+'
+            lits         = child[0].literals;
+            lits.isExact = false;
+            lits.maxLen  = -1;
+            break;
+        }
+        case 8:   // Closure -> Atom '*'
+        case 9: { // Closure -> Atom '?'
+            lits.maxLen = (prodIdx == 8) ? -1 : child[0].literals.maxLen;
+            break;
+        }
+        case 20: { // Closure -> Atom '{'
+            // at least one copy: the atom starts and ends a match
+            auto [m, n]        = getRepeatRange(child[1].lval);
+            const Literals &a = child[0].literals;
+            if (m > 0) { lits = a; }
+            lits.isExact = a.isExact && m == 1 && n == 1;
+            lits.maxLen  = (a.maxLen < 0 || n < 0) ? -1 : a.maxLen * n;
+            break;
+        }
+        case 11: { // Atom -> Char
+            lits.isExact = true;
+            lits.prefix = lits.suffix = string(1, child[0].rval);
+            lits.maxLen               = 1;
+            break;
+        }
+        case 13:   // Range -> '[' RangeSeq ']'
+        case 14:   // Range -> '[' '^' RangeSeq ']'
+        case 19: { // Atom -> '.'
+            lits.maxLen = 1;
+            break;
+        }
+        default: { // RangeSeq, RangeItem: no literal
+            return;
+        }
+    }
+    // prefix and suffix are required literals too
+    addRequired(lits, lits.prefix, 0);
+    addRequired(lits, lits.suffix,
+                lits.maxLen < 0 ? -1 : lits.maxLen - (int) lits.suffix.size());
+}
+
 RegexParser::RegexParser(string regex) : regex_(regex), numNfaNodes(2) {
     lexicalParse();
     syntaxParse();
@@ -552,18 +923,83 @@ NFA RegexParser::nfa() {
     return NFA({nfaGraph, finality});
 }
 
-DFA RegexParser::dfa() { return getMinimizedDfa(getDFAfromNFA(nfa())); }
+DFA RegexParser::dfa(int maxStates) {
+    return getMinimizedDfa(getDFAfromNFA(nfa(), maxStates));
+}
+
+struct PositionsHash {
+    size_t operator()(const vector<int> &positions) const {
+        size_t h = positions.size();
+        for (int pos : positions) { h = h * 1000003u ^ pos; }
+        return h;
+    }
+};
+
+// DFA states are sets of positions, without building NFA
+// the end marker (accepting position) follows lastpos of the root
+DFA RegexParser::followposDfa(int maxStates) {
+    const Node &root   = nodes_.top();
+    const int   endPos = posSymbols_.size();
+    auto        follow = followpos_;
+    for (int pos : root.lastpos) { follow[pos].push_back(endPos); }
+
+    vector<vector<int>>                                 states;
+    std::unordered_map<vector<int>, int, PositionsHash> stateIdx;
+    auto intern = [&](vector<int> &positions) -> int {
+        auto [it, isNew] = stateIdx.emplace(positions, states.size());
+        if (isNew) {
+            states.push_back(std::move(positions));
+            if (maxStates > 0 && states.size() > maxStates) {
+                throw krill::error::state_budget_error(
+                    fmt::format("DFA goes beyond {} states in followpos "
+                                "construction",
+                                maxStates));
+            }
+        }
+        return it->second;
+    };
+    vector<int> initState = root.firstpos;
+    if (root.nullable) { initState.push_back(endPos); }
+    intern(initState);
+
+    DFA                    dfa;
+    vector<pair<int, int>> moves; // {symbol, position}
+    for (int idx = 0; idx < states.size(); idx++) {
+        moves.clear();
+        for (int pos : states[idx]) {
+            if (pos == endPos) { continue; }
+            for (int symbol : posSymbols_[pos]) {
+                moves.push_back({symbol, pos});
+            }
+        }
+        std::sort(moves.begin(), moves.end());
+        for (int i = 0, j; i < moves.size(); i = j) {
+            vector<int> nextState;
+            for (j = i; j < moves.size() && moves[j].first == moves[i].first;
+                 j++) {
+                nextState = getUnion(nextState, follow[moves[j].second]);
+            }
+            dfa.graph[idx][moves[i].first] = intern(nextState);
+        }
+        dfa.finality[idx] =
+            (states[idx].size() > 0 && states[idx].back() == endPos);
+    }
+    return getMinimizedDfa(dfa);
+}
 
 } // namespace krill::regex::core
 
 namespace krill::regex {
 
-DFA getDFAfromRegex(string src) {
+DFA getDFAfromRegex(string src, RegexCompiler compiler, int maxStates) {
     // vector<Token> tokens = core::lexicalParser(src);
     // NFA           nfa    = core::syntaxParser(tokens);
     // DFA           dfa    = getMinimizedDfa(getDFAfromNFA(nfa));
     // return dfa;
-    return core::RegexParser(src).dfa();
+    if (compiler == RegexCompiler::kThompson) {
+        return core::RegexParser(src).dfa(maxStates);
+    }
+    return core::RegexParser(src).followposDfa(maxStates);
 }
 
 NFA getNFAfromRegex(string src) {
@@ -572,4 +1008,208 @@ NFA getNFAfromRegex(string src) {
     // return nfa;
     return core::RegexParser(src).nfa();
 }
+// ---------- GlushkovVM ----------
+
+GlushkovVM::GlushkovVM(string regex) {
+    core::RegexParser parser(regex);
+    const core::Node &root = parser.root();
+    numPositions_          = parser.posSymbols().size();
+    isBitParallel_         = numPositions_ + 1 <= 64;
+
+    // the start pseudo-position is followed by firstpos
+    follow_ = parser.followpos();
+    follow_.push_back(root.firstpos);
+    accepts_.assign(numPositions_, vector<bool>(256, false));
+    for (int pos = 0; pos < numPositions_; pos++) {
+        for (int symbol : parser.posSymbols()[pos]) {
+            accepts_[pos][(unsigned char) symbol] = true;
+        }
+    }
+    isLast_.assign(numPositions_ + 1, false);
+    for (int pos : root.lastpos) { isLast_[pos] = true; }
+    isLast_[numPositions_] = root.nullable;
+    if (!isBitParallel_) { return; }
+
+    // next = followMask(current) & byteMask[c], with follow of 8 positions
+    // looked up at once
+    byteMask_.assign(256, 0);
+    for (int pos = 0; pos < numPositions_; pos++) {
+        for (int c = 0; c < 256; c++) {
+            if (accepts_[pos][c]) { byteMask_[c] |= 1ull << pos; }
+        }
+    }
+    int numChunks = (numPositions_ + 1 + 7) / 8;
+    followMask_.assign(numChunks, vector<uint64_t>(256, 0));
+    for (int chunk = 0; chunk < numChunks; chunk++) {
+        for (int bits = 1; bits < 256; bits++) {
+            uint64_t mask = 0;
+            for (int i = 0; i < 8; i++) {
+                int pos = chunk * 8 + i;
+                if (!(bits >> i & 1) || pos > numPositions_) { continue; }
+                for (int to : follow_[pos]) { mask |= 1ull << to; }
+            }
+            followMask_[chunk][bits] = mask;
+        }
+    }
+    for (int pos = 0; pos <= numPositions_; pos++) {
+        if (isLast_[pos]) { lastMask_ |= 1ull << pos; }
+    }
+}
+
+GlushkovVM::State GlushkovVM::start() const {
+    State state;
+    if (isBitParallel_) {
+        state.bits = 1ull << numPositions_;
+    } else {
+        state.positions = {numPositions_};
+    }
+    return state;
+}
+
+bool GlushkovVM::step(const State &state, unsigned char c, State &next) const {
+    if (isBitParallel_) {
+        uint64_t mask  = 0;
+        int      chunk = 0;
+        for (uint64_t bits = state.bits; bits != 0; bits >>= 8, chunk++) {
+            mask |= followMask_[chunk][bits & 0xff];
+        }
+        next.bits = mask & byteMask_[c];
+        return next.bits != 0;
+    }
+    next.positions.clear();
+    for (int pos : state.positions) {
+        for (int to : follow_[pos]) {
+            if (accepts_[to][c]) { next.positions.push_back(to); }
+        }
+    }
+    std::sort(next.positions.begin(), next.positions.end());
+    next.positions.erase(
+        std::unique(next.positions.begin(), next.positions.end()),
+        next.positions.end());
+    return !next.positions.empty();
+}
+
+bool GlushkovVM::isFinal(const State &state) const {
+    if (isBitParallel_) { return (state.bits & lastMask_) != 0; }
+    for (int pos : state.positions) {
+        if (isLast_[pos]) { return true; }
+    }
+    return false;
+}
+
+// ---------- Searcher ----------
+
+Searcher::Searcher(string pattern) {
+    core::RegexParser parser(pattern);
+    core::Literals    lits = parser.literals();
+    anchored_              = automata::getDFAtable(parser.followposDfa());
+    prefix_                = lits.prefix;
+    required_              = lits.required;
+    reqOffset_             = lits.reqOffset;
+
+    // bytes leaving the start state
+    isFirstByte_.assign(256, false);
+    numFirstBytes_ = 0;
+    for (int c = 0; c < 256; c++) {
+        if (anchored_.trans[anchored_.classMap[c]] >= 0) {
+            isFirstByte_[c] = true;
+            firstByte_      = c;
+            numFirstBytes_++;
+        }
+    }
+
+    // no literal to locate a match: find its end with the unanchored DFA
+    // first, leftmost start is before it (unless empty match accepted)
+    if (prefix_.empty() && (required_.empty() || reqOffset_ < 0) &&
+        anchored_.finality[0] == 0) {
+        NFA nfa = parser.nfa();
+        for (int c = 1; c < 256; c++) { nfa.graph[0].insert({(char) c, 0}); }
+        unanchored_ = automata::getDFAtable(
+            automata::getMinimizedDfa(automata::getDFAfromNFA(nfa)));
+    }
+}
+
+// length of the longest non-empty match starting at p, 0 if none
+size_t Searcher::matchAt(const char *p, const char *ed) const {
+    const int32_t *trans      = anchored_.trans.data();
+    const int      numClasses = anchored_.numClasses;
+    size_t         len        = 0;
+    int            state      = 0;
+    for (const char *q = p; q < ed;) {
+        state = trans[state * numClasses +
+                      anchored_.classMap[(unsigned char) *q++]];
+        if (state < 0) { break; }
+        if (anchored_.finality[state] != 0) { len = q - p; }
+    }
+    return len;
+}
+
+// end of the first match starting at or after p, nullptr if none
+const char *Searcher::earliestEnd(const char *p, const char *ed) const {
+    const int32_t *trans      = unanchored_.trans.data();
+    const int      numClasses = unanchored_.numClasses;
+    int            state      = 0;
+    for (const char *q = p; q < ed;) {
+        state = trans[state * numClasses +
+                      unanchored_.classMap[(unsigned char) *q++]];
+        if (state < 0) {
+            state = 0; // byte 0, not in any pattern
+        } else if (unanchored_.finality[state] != 0) {
+            return q;
+        }
+    }
+    return nullptr;
+}
+
+pair<size_t, size_t> Searcher::find(string_view text, size_t pos) const {
+    const char *base = text.data();
+    const char *ed   = base + text.size();
+    const char *lit  = nullptr; // next required literal at or after p
+    const char *end  = nullptr; // a match starts before end, if found
+    for (const char *p = base + std::min(pos, text.size()); p < ed; p++) {
+        // skip to candidates by literals
+        if (prefix_.size() > 0) {
+            p = (const char *) memmem(p, ed - p, prefix_.data(),
+                                      prefix_.size());
+            if (p == nullptr) { break; }
+        } else if (required_.size() > 0) {
+            if (lit == nullptr || lit < p) {
+                lit = (const char *) memmem(p, ed - p, required_.data(),
+                                            required_.size());
+                if (lit == nullptr) { break; }
+            }
+            if (reqOffset_ >= 0 && lit - p > reqOffset_) {
+                p = lit - reqOffset_;
+            }
+        }
+        // skip to bytes a match can start with
+        if (numFirstBytes_ == 1) {
+            p = (const char *) memchr(p, firstByte_, ed - p);
+            if (p == nullptr) { break; }
+        } else {
+            while (p < ed && !isFirstByte_[(unsigned char) *p]) { p++; }
+            if (p == ed) { break; }
+        }
+        if (unanchored_.numStates > 0 && (end == nullptr || end <= p)) {
+            end = earliestEnd(p, ed);
+            if (end == nullptr) { break; }
+        }
+
+        size_t len = matchAt(p, ed);
+        if (len > 0) { return {p - base, len}; }
+    }
+    return {npos, 0};
+}
+
+vector<pair<size_t, size_t>> Searcher::findAll(string_view text) const {
+    vector<pair<size_t, size_t>> matches;
+    for (size_t pos = 0;;) {
+        auto [offset, length] = find(text, pos);
+        if (offset == npos) { break; }
+        matches.push_back({offset, length});
+        pos = offset + length;
+    }
+    return matches;
+}
+
 } // namespace krill::regex
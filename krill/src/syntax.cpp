@@ -22,92 +22,110 @@ SyntaxParser::SyntaxParser(Grammar grammar, ActionTable actionTable)
     : grammar_(grammar), actionTable_(actionTable), states_({0}), offset_(0),
       isAccepted_(false), history_("") {}
 
-void SyntaxParser::parse() {
-    auto &      prods_   = grammar_.prods;
+void SyntaxParser::logState(int lookId) {
+    // skip building the stack strings if they will not be logged
+    if (!logger.should_log(spdlog::level::debug)) { return; }
     const auto &symNames = grammar_.symbolNames;
+    logger.debug("states_: [{}]", fmt::join(to_vector(states_), ","));
+    logger.debug("symbols_: [{}]",
+                 fmt::join(apply_map(to_vector(symbols_), symNames), ","));
+    logger.debug("  look: {}", symNames.at(lookId));
+}
 
-    while (!isAccepted_ && offset_ < inputs_.size()) {
-        APTnode &input = inputs_.at(offset_);
-        assert(input.attr.Has<string>("lval"));
+void SyntaxParser::shift(int tgt, shared_ptr<APTnode> node) {
+    logger.debug("  ACTION push s{}", tgt);
+    states_.push(tgt);
+    symbols_.push(node->id);
 
-        logger.debug("states_: [{}]", fmt::join(to_vector(states_), ","));
-        logger.debug("symbols_: [{}]",
-                     fmt::join(apply_map(to_vector(symbols_), symNames), ","));
-        logger.debug("  look: {}", symNames.at(input.id));
+    // very stupid history stack, may be improved in the future
+    history_ += " ";
+    history_ += node->attr.CRef<string>("lval");
+    if (history_.size() > 50) { history_.erase(0, history_.size() - 50); }
 
-        assert(states_.size() > 0);
-        if (actionTable_.count({states_.top(), input.id}) == 0) {
-            string error_message = getErrorMessage();
-            // ERROR action
-            errorFunc_(input);
-            throw runtime_error(error_message);
-        }
+    node->pidx = -1;
+    // ACTION action
+    actionFunc_(*node.get()); // bug!
 
-        assert(actionTable_.count({states_.top(), input.id}) != 0);
-        Action action = actionTable_[{states_.top(), input.id}];
+    nodes_.push(std::move(node));
+}
 
-        switch (action.type) {
-        case Action::Type::kAction: {
-            logger.debug("  ACTION push s{}", action.tgt);
-            states_.push(action.tgt);
-            symbols_.push(input.id);
+void SyntaxParser::reduce(int pidx) {
+    assert(0 <= pidx && pidx < grammar_.prods.size());
+    const Prod &               r = grammar_.prods[pidx];
+    deque<shared_ptr<APTnode>> childNodes;
 
-            shared_ptr<APTnode> nextNode(new APTnode(input));
-            nextNode.get()->pidx = -1;
-            // ACTION action
-            actionFunc_(*nextNode.get()); // bug!
+    vector<int> poped_states; // for debug
+    if (logger.should_log(spdlog::level::debug)) {
+        poped_states = get_top(states_, r.right.size());
+    }
+    assert(nodes_.size() >= r.right.size());
+    for (int j = 0; (int) j < r.right.size(); j++) {
+        states_.pop();
+        symbols_.pop();
 
-            nodes_.push(nextNode);
+        childNodes.push_front(nodes_.top());
+        nodes_.pop();
+    }
 
-            // very stupid history stack, may be improved in the future
-            history_ += " ";
-            history_ += input.attr.Get<string>("lval");
-            if (history_.size() > 50) {
-                history_ = history_.substr(history_.size() - 50);
-            }
+    auto it = actionTable_.find({states_.top(), r.symbol});
+    assert(it != actionTable_.end());
+    const Action &action2 = it->second;
+    assert(action2.type == Action::Type::kGoto);
+    states_.push(action2.tgt);
+    symbols_.push(r.symbol);
 
+    logger.debug("  REDUCE r{} pop [{}] GOTO {}", pidx + 1,
+                 fmt::join(poped_states, ","), action2.tgt);
+
+    shared_ptr<APTnode> nextNode(new APTnode({.id    = r.symbol,
+                                              .pidx  = pidx,
+                                              .attr  = {},
+                                              .child = std::move(childNodes)}));
+    // REDUCE action
+    reduceFunc_(*nextNode.get());
+
+    nodes_.push(nextNode);
+}
+
+void SyntaxParser::accept() {
+    logger.debug("  ACCEPT");
+    logger.info("syntax parsing complete successfully");
+    if (logger.should_log(spdlog::level::debug)) {
+        logger.debug("Current AST: \n{}", getASTstr());
+    }
+    isAccepted_ = true;
+}
+
+void SyntaxParser::error(APTnode &input) {
+    string error_message = getErrorMessage(input);
+    // ERROR action
+    errorFunc_(input);
+    throw runtime_error(error_message);
+}
+
+void SyntaxParser::parse() {
+    while (!isAccepted_ && offset_ < inputs_.size()) {
+        APTnode &input = inputs_.at(offset_);
+        assert(input.attr.Has<string>("lval"));
+        logState(input.id);
+
+        assert(states_.size() > 0);
+        auto it = actionTable_.find({states_.top(), input.id});
+        if (it == actionTable_.end()) { error(input); }
+        const Action &action = it->second;
+
+        switch (action.type) {
+        case Action::Type::kAction: {
+            shift(action.tgt, make_shared<APTnode>(input));
             offset_++;
             break;
         }
         case Action::Type::kReduce: {
-            Prod                       r = prods_[action.tgt];
-            deque<shared_ptr<APTnode>> childNodes;
-
-            auto poped_states = get_top(states_, r.right.size());
-            assert(nodes_.size() >= r.right.size());
-            for (int j = 0; (int) j < r.right.size(); j++) {
-                states_.pop();
-                symbols_.pop();
-
-                childNodes.push_front(nodes_.top());
-                nodes_.pop();
-            }
-
-            assert(actionTable_.count({states_.top(), r.symbol}) != 0);
-            Action action2 = actionTable_[{states_.top(), r.symbol}];
-            assert(action2.type == Action::Type::kGoto);
-            states_.push(action2.tgt);
-            symbols_.push(r.symbol);
-            assert(0 <= action.tgt && action.tgt < prods_.size());
-
-            logger.debug("  REDUCE r{} pop [{}] GOTO {}", action.tgt + 1,
-                         fmt::join(poped_states, ","), action2.tgt);
-
-            shared_ptr<APTnode> nextNode(new APTnode({.id    = r.symbol,
-                                                      .pidx  = action.tgt,
-                                                      .attr  = {},
-                                                      .child = childNodes}));
-            // REDUCE action
-            reduceFunc_(*nextNode.get());
-
-            nodes_.push(nextNode);
+            reduce(action.tgt);
             break;
         }
         case Action::Type::kAccept: {
-            logger.debug("  ACCEPT");
-            logger.info("syntax parsing complete successfully");
-            logger.debug("Current AST: \n{}", getASTstr());
-            isAccepted_ = true;
+            accept();
             break;
         }
         default: {
@@ -121,6 +139,7 @@ void SyntaxParser::parse() {
 void SyntaxParser::clear() {
     inputs_.clear();
     states_     = stack<int>();
+    symbols_    = stack<int>();
     nodes_      = stack<shared_ptr<APTnode>>();
     offset_     = 0;
     isAccepted_ = false;
@@ -135,6 +154,13 @@ APTnode to_APTnode(const Token &token) {
     return node;
 }
 
+APTnode to_APTnode(const TokenView &token, string_view source) {
+    APTnode node;
+    node.id = token.id;
+    node.attr.Set<string>("lval", string(token.lval(source)));
+    return node;
+}
+
 void SyntaxParser::parseStep(Token token) {
     inputs_.push_back(to_APTnode(token));
     parse();
@@ -159,6 +185,44 @@ void SyntaxParser::parseAll(vector<APTnode> tokensWithAttr) {
     parse();
 }
 
+// read tokens from the columns of token buffer directly, lval located in
+// source; a node is created only when its token is shifted
+void SyntaxParser::parseAll(const TokenBuffer &tokens, string_view source) {
+    for (size_t i = 0; !isAccepted_ && i < tokens.size();) {
+        int lookId = tokens.ids[i];
+        logState(lookId);
+
+        assert(states_.size() > 0);
+        auto it = actionTable_.find({states_.top(), lookId});
+        if (it == actionTable_.end()) {
+            APTnode input = to_APTnode(tokens[i], source);
+            error(input);
+        }
+        const Action &action = it->second;
+
+        switch (action.type) {
+        case Action::Type::kAction: {
+            shift(action.tgt,
+                  make_shared<APTnode>(to_APTnode(tokens[i], source)));
+            i++;
+            break;
+        }
+        case Action::Type::kReduce: {
+            reduce(action.tgt);
+            break;
+        }
+        case Action::Type::kAccept: {
+            accept();
+            break;
+        }
+        default: {
+            assert(false);
+            break;
+        }
+        }
+    }
+}
+
 shared_ptr<APTnode> SyntaxParser::getAPT() {
     if (!isAccepted_) {
         assert(false);
@@ -238,8 +302,7 @@ string SyntaxParser::getASTstr() {
     return ss.str();
 }
 
-string SyntaxParser::getErrorMessage() {
-    auto & tokenWithAttr = inputs_.at(offset_);
+string SyntaxParser::getErrorMessage(const APTnode &tokenWithAttr) {
     string errorMsg      = fmt::format(
         "syntax parsing error: unexpected {}",
         tokenWithAttr.id == END_SYMBOL
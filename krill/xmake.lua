@@ -7,3 +7,4 @@ target('krill')
   add_files('src/**.cpp')
   add_deps('cxxopts', {public = true})
   add_packages('spdlog', 'magic_enum', {public = true})
+  add_syslinks('pthread', {public = true})
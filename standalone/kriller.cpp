@@ -1,4 +1,5 @@
 #include "fmt/format.h"
+#include "krill/cache.h"
 #include "krill/codegen.h"
 #include "krill/grammar.h"
 #include "krill/lexical.h"
@@ -204,7 +205,7 @@ void parse_syntax(istream &input, ostream &output, bool is_syntax_yacc,
 }
 
 void parse_lexical(istream &input, ostream &output, bool is_lexical,
-                   bool test_mode, bool gen_mode) {
+                   bool test_mode, bool gen_mode, bool direct) {
     assert(input);
     assert(output);
 
@@ -248,7 +249,18 @@ void parse_lexical(istream &input, ostream &output, bool is_lexical,
         }
 
     } else if (gen_mode) {
-        genLexicalParser(regexs, output);
+        // generated code has no GlushkovVM, a rule beyond state budget fails
+        try {
+            if (direct) {
+                genLexicalParserDirect(regexs, output);
+            } else {
+                genLexicalParser(regexs, output);
+            }
+        } catch (exception &e) {
+            std::cerr << fmt::format("kriller: \033[31merror:\033[0m {}\n",
+                                     e.what());
+            exit(1);
+        }
     }
 }
 
@@ -267,6 +279,18 @@ int main(int argc, char **argv) {
         "t,test", "Test mode, interact immediately to test the parser.");
     opts.add_options("MODE")("g,gen",
                              "Generator mode, generate code of the parser.");
+    opts.add_options()("d,direct",
+                       "Generate direct-coded (goto-based) lexical parser, "
+                       "without dependency on krill.");
+    opts.add_options()("c,cache",
+                       "Cache directory of compiled lexical DFAs "
+                       "(KRILL_CACHE_DIR by default).",
+                       cxxopts::value<string>()->default_value(""));
+    opts.add_options()("m,max-states",
+                       "State budget of the DFA of a lexical rule, a rule "
+                       "beyond it runs by NFA simulation (0 for no limit).",
+                       cxxopts::value<int>()->default_value(
+                           std::to_string(krill::runtime::maxRuleStates)));
     opts.add_options()("i,input", "Input file.",
                        cxxopts::value<string>()->default_value("stdin"));
     opts.add_options()("o,output", "Output file.",
@@ -290,9 +314,12 @@ int main(int argc, char **argv) {
     bool   is_lexical      = result["lexical"].as<bool>();
     bool   test_mode       = result["test"].as<bool>();
     bool   gen_mode        = result["gen"].as<bool>();
+    bool   direct          = result["direct"].as<bool>();
     string input_filename  = result["input"].as<string>();
     string output_filename = result["output"].as<string>();
     bool   verbose         = result["verbose"].as<bool>();
+    string cache_dir       = result["cache"].as<string>();
+    int    max_states      = result["max-states"].as<int>();
 
     ifstream input_file;
     ofstream output_file;
@@ -353,6 +380,13 @@ int main(int argc, char **argv) {
         is_legal = false;
     }
 
+    if (direct && !(is_lexical && gen_mode)) {
+        std::cerr << fmt::format(
+            "kriller: \033[31merror:\033[0m: direct-coded parser is only "
+            "available in lexical PATTERN and generator MODE\n");
+        is_legal = false;
+    }
+
     if (!is_legal) { exit(1); }
 
     if (is_syntax_yacc) {
@@ -369,11 +403,20 @@ int main(int argc, char **argv) {
         spdlog::debug("Mode: generator");
     }
 
+    if (cache_dir.size() > 0) { krill::cache::setDefaultCache(cache_dir); }
+    krill::runtime::maxRuleStates = max_states;
+
     if (is_syntax_yacc || is_syntax) {
         parse_syntax(*input, *output, is_syntax_yacc, is_syntax, test_mode,
                      gen_mode);
     } else if (is_lexical) {
-        parse_lexical(*input, *output, is_lexical, test_mode, gen_mode);
+        parse_lexical(*input, *output, is_lexical, test_mode, gen_mode,
+                      direct);
+        if (auto *cache = krill::cache::getDefaultCache()) {
+            spdlog::debug("DFA cache {}: {} hits, {} misses, {} evictions",
+                          cache->dir(), cache->numHits(), cache->numMisses(),
+                          cache->numEvictions());
+        }
     }
 
     return 0;
@@ -27,7 +27,7 @@ void parse_example(istream &input, ostream &output) {
     parser.parseAll(input);
     auto aptRoot = parser.getAptNode();
     // syntax-directed translation
-    auto sdtParser = krill::minic::SdtParser(aptRoot.get());
+    auto sdtParser = krill::minic::SdtParser(aptRoot.get(), &parser);
     auto ir        = sdtParser.parse().get();
 
     // optimization
@@ -63,7 +63,7 @@ void parse(istream &input, ostream &output, int opt_level, bool ast_only,
     }
 
     // syntax-directed translation
-    auto sdtParser = krill::minic::SdtParser(root.get());
+    auto sdtParser = krill::minic::SdtParser(root.get(), &parser);
     auto ir        = sdtParser.parse().get();
     to_string(ir.code());
 
@@ -1,7 +1,11 @@
 #include "krill/defs.h"
 #include "krill/automata.h"
+#include "krill/regex.h"
+#include "krill/utils.h"
 #include "fmt/format.h"
+#include <chrono>
 #include <iostream>
+#include <random>
 using namespace std;
 using namespace krill::type;
 using namespace krill::automata;
@@ -169,8 +173,222 @@ void test3() {
     printDFA(dfai, cout);
 }
 
+// merge equivalent states by recoloring until fixpoint, as reference
+DFA getMergedDfaByRecoloring(DFA dfa) {
+    map<int, int> stateColor = dfa.finality;
+    using DFAnode            = pair<int, map<int, int>>;
+    for (int numSplited = 1;;) {
+        map<DFAnode, set<int>> partition;
+        for (auto [state, _] : dfa.finality) {
+            DFAnode node = {stateColor[state], dfa.graph[state]};
+            for (auto &[symbol, to] : node.second) { to = stateColor[to]; }
+            partition[node].insert(state);
+        }
+        if (numSplited == partition.size()) { break; }
+        numSplited = partition.size();
+        int color  = 0;
+        for (auto &[_, states] : partition) {
+            for (int state : states) { stateColor[state] = color; }
+            color++;
+        }
+    }
+    map<int, int> colorRep;
+    for (auto [state, color] : stateColor) {
+        if (colorRep.count(color) == 0) { colorRep[color] = state; }
+    }
+    DFA resDfa;
+    for (auto [from, edges] : dfa.graph) {
+        for (auto [symbol, to] : edges) {
+            resDfa.graph[colorRep[stateColor[from]]][symbol] =
+                colorRep[stateColor[to]];
+        }
+    }
+    for (auto [state, finality] : dfa.finality) {
+        resDfa.finality[colorRep[stateColor[state]]] = finality;
+    }
+    return resDfa;
+}
+
+// test Hopcroft minimization against recoloring, and benchmark it
+void test4() {
+    printf("test minimization of DFA (Hopcroft) \n");
+    printf("----------------------------------- \n");
+    // random partial DFAs
+    std::mt19937 rng(2022);
+    for (int t = 0; t < 500; t++) {
+        int numStates = 1 + rng() % 40;
+        DFA dfa;
+        for (int state = 0; state < numStates; state++) {
+            dfa.finality[state] = rng() % 3;
+            for (int symbol = 'a'; symbol <= 'd'; symbol++) {
+                if (rng() % 4 != 0) {
+                    dfa.graph[state][symbol] = rng() % numStates;
+                }
+            }
+        }
+        DFA dfa1 = getMinimizedDfa(dfa);
+        DFA dfa2 = getReachableDfa(getMergedDfaByRecoloring(dfa));
+        assert(dfa1.graph == dfa2.graph && dfa1.finality == dfa2.finality);
+    }
+    printf("random DFAs: same as recoloring \n");
+
+    // lexer spec with a few hundred token regexes
+    vector<string> regexs;
+    for (int i = 0; i < 200; i++) {
+        string word;
+        for (int len = 2 + rng() % 8; len > 0; len--) {
+            word += 'a' + rng() % 26;
+        }
+        regexs.push_back(i % 3 == 0 ? word : i % 3 == 1 ? word + "[0-9]+"
+                                                        : word + "(_[a-z]+)*");
+    }
+    regexs.push_back("[a-zA-Z_][a-zA-Z_0-9]*");
+    regexs.push_back("[0-9]+");
+    regexs.push_back("[ \t\n]+");
+    vector<DFA> dfas;
+    for (const string &regex : regexs) {
+        dfas.push_back(krill::regex::getDFAfromRegex(regex));
+    }
+
+    auto timeit = [](auto func) {
+        auto t0 = chrono::steady_clock::now();
+        func();
+        return chrono::duration<double>(chrono::steady_clock::now() - t0)
+            .count();
+    };
+    auto minimizeByRecoloring = [](DFA dfa) {
+        return getReachableDfa(getMergedDfaByRecoloring(dfa));
+    };
+    // minimize every regex, as getDFAintegrated does
+    vector<DFA> dfas1 = dfas, dfas2 = dfas;
+    double      t1    = timeit([&]() {
+        for (auto &dfa : dfas1) { dfa = getMinimizedDfa(dfa); }
+    });
+    double      t2    = timeit([&]() {
+        for (auto &dfa : dfas2) { dfa = minimizeByRecoloring(dfa); }
+    });
+    for (int i = 0; i < dfas.size(); i++) {
+        assert(dfas1[i].graph == dfas2[i].graph);
+        for (auto &[state, finality] : dfas1[i].finality) {
+            if (finality != 0) { finality = i + 1; }
+        }
+    }
+    // minimize the integrated one
+    DFA    raw = _getDFAintegrated(dfas1);
+    DFA    dfai1, dfai2;
+    double t3 = timeit([&]() { dfai1 = getMinimizedDfa(raw); });
+    double t4 = timeit([&]() { dfai2 = minimizeByRecoloring(raw); });
+    assert(dfai1.graph == dfai2.graph && dfai1.finality == dfai2.finality);
+    printf("%zu regexs, integrated DFA: %zu states -> %zu states \n",
+           regexs.size(), raw.finality.size(), dfai1.finality.size());
+    printf("minimize each regex:     hopcroft %.3fs, recoloring %.3fs \n", t1,
+           t2);
+    printf("minimize integrated DFA: hopcroft %.3fs, recoloring %.3fs \n", t3,
+           t4);
+}
+
+// subset construction by linear search of closures, as reference
+pair<DFAgraph, ClosureMap> getClosureMapByLinearSearch(const NFAgraph &nfa) {
+    vector<Closure> closures({{0}});
+    DFAgraph        dfaGraph;
+    setClosureExpanded(closures[0], nfa);
+    for (int idx = 0; idx < closures.size(); idx++) {
+        for (auto &[symbol, next] : getNextClosures(closures[idx], nfa)) {
+            auto it = find(closures.begin(), closures.end(), next);
+            if (it == closures.end()) { it = closures.insert(it, next); }
+            dfaGraph[idx][symbol] = it - closures.begin();
+        }
+    }
+    ClosureMap closureMap;
+    for (int idx = 0; idx < closures.size(); idx++) {
+        closureMap[idx] = closures[idx];
+    }
+    return {dfaGraph, closureMap};
+}
+
+// test subset construction with interned closures
+void test5() {
+    printf("test subset construction (NFA -> DFA) \n");
+    printf("------------------------------------- \n");
+    auto timeit = [](auto func) {
+        auto t0 = chrono::steady_clock::now();
+        func();
+        return chrono::duration<double>(chrono::steady_clock::now() - t0)
+            .count();
+    };
+
+    std::mt19937 rng(2022);
+    string       keywords;
+    for (int i = 0; i < 200; i++) {
+        for (int len = 2 + rng() % 8; len > 0; len--) {
+            keywords += 'a' + rng() % 26;
+        }
+        keywords += '|';
+    }
+    vector<pair<string, string>> specs = {
+        {"[^\\n\\r]*", "//[^\n\r]*"},
+        {"/\\*...\\*/", "/\\*([^\\*]|\\*+[^\\*/])*\\*+/"},
+        {"200 keywords", keywords + "[a-zA-Z_][a-zA-Z_0-9]*"},
+    };
+    for (auto &[name, regex] : specs) {
+        NFA nfa = krill::regex::getNFAfromRegex(regex);
+        pair<DFAgraph, ClosureMap> res1, res2;
+        double                     t1 = timeit(
+            [&]() { res1 = getClosureMapfromNFAgraph(nfa.graph); });
+        double                     t2 = timeit(
+            [&]() { res2 = getClosureMapByLinearSearch(nfa.graph); });
+        assert(res1 == res2);
+        printf("%-16s %4zu NFA states -> %4zu DFA states, interned %.4fs, "
+               "linear search %.4fs \n",
+               name.c_str(), nfa.finality.size(), res1.second.size(), t1, t2);
+    }
+}
+
+void test6() {
+    printf("test parallel DFA construction \n");
+    printf("------------------------------ \n");
+    std::mt19937   rng(2022);
+    vector<string> regexs;
+    for (int i = 0; i < 500; i++) {
+        string word;
+        for (int len = 3 + rng() % 8; len > 0; len--) {
+            word += 'a' + rng() % 26;
+        }
+        regexs.push_back(i % 2 ? word : word + "[0-9]+");
+    }
+    regexs.push_back("[a-zA-Z_][a-zA-Z_0-9]*");
+    regexs.push_back("[0-9]+(\\.[0-9]+)?");
+    regexs.push_back("[ \t\n]+");
+
+    // same table, byte by byte, on any number of threads
+    int      threads0 = krill::utils::parallel_threads();
+    DFAtable table0;
+    for (int threads : {1, 2, 4, 8}) {
+        krill::utils::parallel_threads() = threads;
+        auto        t0 = chrono::steady_clock::now();
+        vector<DFA> dfas(regexs.size());
+        krill::utils::parallel_for(regexs.size(), [&](size_t i) {
+            dfas[i] = krill::regex::getDFAfromRegex(regexs[i]);
+        });
+        auto     t1    = chrono::steady_clock::now();
+        DFAtable table = getDFAtable(getDFAintegrated(dfas));
+        auto     t2    = chrono::steady_clock::now();
+        if (threads == 1) { table0 = table; }
+        assert(table.classMap == table0.classMap &&
+               table.trans == table0.trans &&
+               table.finality == table0.finality);
+        printf("%zu rules, %d threads: regex %.4fs, integrated %.4fs, "
+               "%d states\n",
+               regexs.size(), threads,
+               chrono::duration<double>(t1 - t0).count(),
+               chrono::duration<double>(t2 - t1).count(), table.numStates);
+    }
+    printf("(%u hardware threads)\n", std::thread::hardware_concurrency());
+    krill::utils::parallel_threads() = threads0;
+}
+
 int main() {
-    vector<void (*)()> testFuncs = {test1, test2, test3};
+    vector<void (*)()> testFuncs = {test1, test2, test3, test4, test5, test6};
     for (int i = 0; i < testFuncs.size(); i++) {
         cout << "#test " << (i + 1) << endl;
         testFuncs[i]();
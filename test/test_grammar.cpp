@@ -1,9 +1,14 @@
 #include "krill/defs.h"
 #include "krill/grammar.h"
+#include "krill/minic.h"
+#include "krill/utils.h"
 #include "spdlog/spdlog.h"
 #include <cassert>
+#include <chrono>
 #include <fmt/format.h>
+#include <fstream>
 #include <iostream>
+#include <thread>
 #include <vector>
 using namespace std;
 using namespace krill::type;
@@ -327,9 +332,226 @@ void test5() {
     printGrammarTreeNode(root, grammar.symbolNames, cout);
 }
 
+// grammar file of simple format, one production per line
+Grammar readGrammarFile(const string &path) {
+    ifstream       file(path);
+    vector<string> prodStrs;
+    string         line;
+    assert(file);
+    while (getline(file, line)) {
+        krill::utils::trim(line);
+        if (line.size() > 0) { prodStrs.push_back(line); }
+    }
+    return Grammar(prodStrs);
+}
+
+void test6() {
+    fmt::print("test LALR(1) automata built directly \n");
+    fmt::print("------------------------------------ \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::warn); // conflicts logged
+
+    vector<pair<string, Grammar>> grammars;
+    for (string name : {"calculator.syntax", "minic.syntax", "regex.syntax"}) {
+        grammars.push_back({name, readGrammarFile("test/grammar/" + name)});
+    }
+    grammars.push_back({"minic.syntax.yacc", krill::minic::MinicGrammar()});
+    grammars.push_back({"not LALR(1)", Grammar({
+                                           "S -> X",
+                                           "X -> a A d",
+                                           "X -> b B d",
+                                           "X -> a B e",
+                                           "X -> b A e",
+                                           "A -> c",
+                                           "B -> c",
+                                       })});
+
+    auto isSame = [](const ActionTable &a, const ActionTable &b) {
+        return a.size() == b.size() &&
+               std::equal(a.begin(), a.end(), b.begin(),
+                          [](const auto &x, const auto &y) {
+                              return x.first == y.first &&
+                                     x.second.type == y.second.type &&
+                                     x.second.tgt == y.second.tgt;
+                          });
+    };
+    for (auto &[name, grammar] : grammars) {
+        auto t0 = std::chrono::steady_clock::now();
+        auto lalr1Automata1 =
+            getLALR1fromLR1(grammar, getLR1automata(grammar));
+        auto t1             = std::chrono::steady_clock::now();
+        auto lalr1Automata2 = getLALR1automata(grammar);
+        auto t2             = std::chrono::steady_clock::now();
+        assert(lalr1Automata1.states == lalr1Automata2.states);
+        assert(lalr1Automata1.edgeTable == lalr1Automata2.edgeTable);
+        assert(isSame(getLR1table(grammar, lalr1Automata1),
+                      getLR1table(grammar, lalr1Automata2)));
+        fmt::print("{}: {} states, {:.4f}s from LR(1), {:.4f}s directly\n",
+                   name, lalr1Automata2.states.size(),
+                   std::chrono::duration<double>(t1 - t0).count(),
+                   std::chrono::duration<double>(t2 - t1).count());
+    }
+    krill::log::logger.set_level(level);
+}
+
+// synthetic grammar of 1000 productions:
+// statements of many keywords, expressions of 20 precedence levels
+Grammar getLargeGrammar() {
+    vector<string> prodStrs = {"Program -> Stmts", "Stmts -> Stmts Stmt",
+                               "Stmts -> Stmt"};
+    int            numLevels = 20;
+    for (int i = 0; i < numLevels; i++) {
+        prodStrs.push_back(fmt::format("E{} -> E{} o{} E{}", i, i, i, i + 1));
+        prodStrs.push_back(fmt::format("E{} -> E{}", i, i + 1));
+    }
+    prodStrs.push_back(fmt::format("E{} -> ( E0 )", numLevels));
+    prodStrs.push_back(fmt::format("E{} -> id", numLevels));
+    for (int i = 0; prodStrs.size() < 1000; i++) {
+        prodStrs.push_back(fmt::format("Stmt -> k{} E0 ;", i));
+    }
+    return Grammar(prodStrs);
+}
+
+void test7() {
+    fmt::print("test LR(1) automata of large grammars \n");
+    fmt::print("------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::warn);
+
+    vector<pair<string, Grammar>> grammars = {
+        {"minic.syntax.yacc", krill::minic::MinicGrammar()},
+        {"synthetic", getLargeGrammar()},
+    };
+    for (auto &[name, grammar] : grammars) {
+        auto t0          = std::chrono::steady_clock::now();
+        auto lr1Automata = getLR1automata(grammar);
+        auto t1          = std::chrono::steady_clock::now();
+
+        // no state repeated, and merged into the same LALR(1) automata
+        set<LR1State> states(lr1Automata.states.begin(),
+                             lr1Automata.states.end());
+        assert(states.size() == lr1Automata.states.size());
+        assert(getLALR1fromLR1(grammar, lr1Automata).states ==
+               getLALR1automata(grammar).states);
+        fmt::print("{}: {} productions, {} states, {} edges, {:.4f}s\n", name,
+                   grammar.prods.size(), lr1Automata.states.size(),
+                   lr1Automata.edgeTable.size(),
+                   std::chrono::duration<double>(t1 - t0).count());
+    }
+    krill::log::logger.set_level(level);
+}
+
+void test8() {
+    fmt::print("test grammar index \n");
+    fmt::print("------------------ \n");
+    Grammar grammar({
+        "S -> T",
+        "T -> A B c",
+        "A -> a A",
+        "A ->",
+        "B -> B b",
+        "B -> A",
+    });
+    GrammarIndex index(grammar);
+    auto         symbolId = [&](const string &name) {
+        for (auto [symbol, symbolName] : grammar.symbolNames) {
+            if (symbolName == name) { return index.ids.at(symbol); }
+        }
+        assert(false);
+        return -1;
+    };
+    auto names = [&](const Bitset &bits) {
+        string str;
+        bits.forEach([&](int id) {
+            str += grammar.symbolNames.at(index.symbols[id]);
+        });
+        std::sort(str.begin(), str.end());
+        return str;
+    };
+
+    for (string name : {"S", "T", "A", "B"}) {
+        fmt::print("FIRST({}) = {{{}}}{}\n", name,
+                   names(index.firstSets[symbolId(name)]),
+                   index.isNullable[symbolId(name)] ? ", nullable" : "");
+    }
+    assert(index.isTerminal(symbolId("a")) && !index.isTerminal(symbolId("A")));
+    assert(index.prodsOf[symbolId("B")] == vector<int>({4, 5}));
+    assert(names(index.firstSets[symbolId("A")]) == "a");
+    assert(names(index.firstSets[symbolId("B")]) == "ab");
+    assert(names(index.firstSets[symbolId("T")]) == "abc");
+    assert(index.isNullable[symbolId("A")] && index.isNullable[symbolId("B")]);
+    assert(!index.isNullable[symbolId("T")]);
+
+    // suffixes of T -> A B c
+    assert(names(index.suffixFirstSets[1][1]) == "abc");
+    assert(names(index.suffixFirstSets[1][2]) == "c");
+    assert(names(index.suffixFirstSets[1][3]) == "");
+    assert(!index.isSuffixNullable[1][1] && index.isSuffixNullable[1][3]);
+}
+
+void test9() {
+    fmt::print("test LR(1) closure with search symbol sets \n");
+    fmt::print("------------------------------------------ \n");
+    Grammar grammar({
+        "Q -> S",
+        "S -> L = R",
+        "S -> R",
+        "L -> * R",
+        "L -> i",
+        "R -> L",
+    });
+    GrammarIndex index(grammar);
+
+    // closure of (Q -> ·S, ζ)
+    LR1State state = {{{0, 0}, Bitset(index.numTerminals)}};
+    state.at({0, 0}).insert(index.ids.at(END_SYMBOL));
+    state = getLR1StateExpanded(state, index);
+    fmt::print("{}", to_string(state, grammar));
+
+    auto searchNames = [&](ProdItem core) {
+        set<string> names;
+        state.at(core).forEach([&](int id) {
+            names.insert(grammar.symbolNames.at(index.symbols[id]));
+        });
+        return names;
+    };
+    assert(state.size() == 6);
+    assert(searchNames({3, 0}) == set<string>({"=", "ζ"})); // L -> ·* R
+    assert(searchNames({4, 0}) == set<string>({"=", "ζ"})); // L -> ·i
+    assert(searchNames({5, 0}) == set<string>({"ζ"}));      // R -> ·L
+}
+
+void test10() {
+    fmt::print("test LR(1) automata built on many threads \n");
+    fmt::print("----------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::warn);
+
+    // same states and edges, in the same order, on any number of threads
+    Grammar     grammar  = getLargeGrammar();
+    int         threads0 = krill::utils::parallel_threads();
+    LR1Automata lr1Automata0;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        krill::utils::parallel_threads() = threads;
+        auto t0          = std::chrono::steady_clock::now();
+        auto lr1Automata = getLR1automata(grammar);
+        auto t1          = std::chrono::steady_clock::now();
+        if (threads == 1) { lr1Automata0 = lr1Automata; }
+        assert(lr1Automata.states == lr1Automata0.states);
+        assert(lr1Automata.edgeTable == lr1Automata0.edgeTable);
+        fmt::print("synthetic, {} threads: {} states, {:.4f}s\n", threads,
+                   lr1Automata.states.size(),
+                   std::chrono::duration<double>(t1 - t0).count());
+    }
+    fmt::print("({} hardware threads)\n", std::thread::hardware_concurrency());
+    krill::utils::parallel_threads() = threads0;
+    krill::log::logger.set_level(level);
+}
+
 int main() {
     krill::log::sink_cerr->set_level(spdlog::level::debug);
-    vector<void (*)()> testFuncs = {test1, test2, test3, test4, test5};
+    vector<void (*)()> testFuncs = {test1, test2, test3, test4, test5,
+                                   test6, test7, test8, test9, test10};
     // vector<void (*)()> testFuncs = { test5};
     for (int i = 0; i < testFuncs.size(); i++) {
         cout << "#test " << (i + 1) << "\n";
@@ -1,17 +1,28 @@
 #include "fmt/core.h"
 #include "krill/defs.h"
 #include "krill/automata.h"
+#include "krill/cache.h"
+#include "krill/codegen.h"
 #include "krill/grammar.h"
 #include "krill/lexical.h"
 #include "krill/regex.h"
 #include "krill/utils.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <map>
+#include <random>
 #include <sstream>
+#include <thread>
 #include <vector>
 using namespace std;
 using krill::regex::getDFAfromRegex;
-using krill::automata::getDFAintegrated;
+using krill::automata::getDFAintegrated, krill::automata::getDFAtable;
+using krill::automata::getDFAaccels, krill::automata::getNFAintegrated;
+using krill::automata::getMinimizedDfa;
 using namespace krill::type;
 using namespace krill::utils;
 using namespace krill::runtime;
@@ -42,7 +53,8 @@ SimpleLexicalParser::SimpleLexicalParser(Grammar             grammar,
         lexicalNames[i] = name;
         i++;
     }
-    dfa_ = getDFAintegrated(dfas);
+    dfa_   = getDFAintegrated(dfas);
+    table_ = getDFAtable(dfa_);
 
     // map<string, int> tokenNames_r = reverse(tokenNames_);
     auto tokenNames_r = reverse<int, string>(tokenNames_);
@@ -236,9 +248,816 @@ void test2() {
     }
 }
 
+// read file of test directory, from repo root or build directory
+string readTestFile(string path) {
+    for (string prefix : {"", "../", "../../"}) {
+        ifstream file(prefix + path);
+        if (file) {
+            stringstream ss;
+            ss << file.rdbuf();
+            return ss.str();
+        }
+    }
+    throw runtime_error(fmt::format("cannot open test file {}", path));
+}
+
+// regexs of test/grammar/minic.lexical, with block comment fully matched
+vector<string> getMinicRegexs() {
+    vector<string> regexs;
+    stringstream   ss(readTestFile("test/grammar/minic.lexical"));
+    for (string line; getline(ss, line);) {
+        trim(line);
+        if (line.size() == 0) { continue; }
+        regexs.push_back(line == "/\\*" ? "/\\*([^\\*]|\\*+[^\\*/])*\\*+/" : line);
+    }
+    return regexs;
+}
+
+// source of test/minic-testcase, repeated to about 1MB
+string getMinicSource() {
+    string src;
+    for (int i = 1; i <= 14; i++) {
+        src += readTestFile(fmt::format("test/minic-testcase/{:02d}.c", i));
+    }
+    string res;
+    while (res.size() < (1 << 20)) { res += src; }
+    return res;
+}
+
+// lexical parsing by walking DFAgraph (map of map) directly, as reference
+int countTokensByGraph(const DFA &dfa, const string &src) {
+    int numTokens = 0;
+    int state     = 0;
+    for (size_t i = 0; i <= src.size(); i++) {
+        int c = (i < src.size()) ? src[i] : -1;
+        if (dfa.graph.count(state) == 0 || dfa.graph.at(state).count(c) == 0) {
+            assert(dfa.finality.at(state) != 0);
+            numTokens++;
+            state = 0;
+            if (i == src.size()) { break; }
+            i--;
+            continue;
+        }
+        state = dfa.graph.at(state).at(c);
+    }
+    return numTokens;
+}
+
+// lexical parsing by walking DFAtable
+int countTokensByTable(const DFAtable &table, const string &src) {
+    int numTokens = 0;
+    int state     = 0;
+    for (size_t i = 0; i <= src.size(); i++) {
+        int next = (i < src.size())
+                       ? table.trans[state * table.numClasses +
+                                     table.classMap[(unsigned char) src[i]]]
+                       : -1;
+        if (next < 0) {
+            assert(table.finality[state] != 0);
+            numTokens++;
+            state = 0;
+            if (i == src.size()) { break; }
+            i--;
+            continue;
+        }
+        state = next;
+    }
+    return numTokens;
+}
+
+template <typename F> double timeit(F func, int repeat = 3) {
+    double best = 1e100;
+    for (int i = 0; i < repeat; i++) {
+        auto st = chrono::steady_clock::now();
+        func();
+        auto ed = chrono::steady_clock::now();
+        best    = min(best, chrono::duration<double>(ed - st).count());
+    }
+    return best;
+}
+
+void test3() {
+    fmt::print("benchmark lexical parsing on minic testcases \n");
+    fmt::print("-------------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    vector<string> regexs = getMinicRegexs();
+    string         src    = getMinicSource();
+    vector<DFA>    dfas;
+    for (string regex : regexs) { dfas.push_back(getDFAfromRegex(regex)); }
+    DFA           dfa   = getDFAintegrated(dfas);
+    DFAtable      table = getDFAtable(dfa);
+    LexicalParser parser(dfa);
+
+    int    numTokens1 = 0, numTokens2 = 0, numTokens3 = 0;
+    double t1 = timeit([&]() { numTokens1 = countTokensByGraph(dfa, src); });
+    double t2 = timeit([&]() { numTokens2 = countTokensByTable(table, src); });
+    double t3 = timeit([&]() {
+        parser.clear();
+        stringstream ss(src);
+        numTokens3 = parser.parseAll(ss).size() - 1; // drop END_TOKEN
+    });
+    assert(numTokens1 == numTokens2 && numTokens2 == numTokens3);
+
+    double mb = src.size() / 1e6;
+    fmt::print("input: {} bytes, {} tokens, {} states, {} classes\n",
+               src.size(), numTokens1, table.numStates, table.numClasses);
+    fmt::print("  DFAgraph walk:         {:8.2f} MB/s\n", mb / t1);
+    fmt::print("  DFAtable walk:         {:8.2f} MB/s\n", mb / t2);
+    fmt::print("  LexicalParser (istream): {:6.2f} MB/s\n", mb / t3);
+    krill::log::logger.set_level(level);
+}
+
+void test4() {
+    fmt::print("test byte classes of lexical DFA tables \n");
+    fmt::print("--------------------------------------- \n");
+    for (string name : {"minic", "regex", "calculator"}) {
+        vector<DFA>  dfas;
+        stringstream ss(readTestFile(fmt::format("test/grammar/{}.lexical", name)));
+        for (string line; getline(ss, line);) {
+            trim(line);
+            if (line.size() == 0) { continue; }
+            dfas.push_back(getDFAfromRegex(line));
+        }
+        DFA      dfa   = getDFAintegrated(dfas);
+        DFAtable table = getDFAtable(dfa);
+
+        // every byte should step the same way as in DFAgraph
+        for (auto[state, _] : dfa.finality) {
+            for (int c = 1; c < 128; c++) {
+                int next = table.trans[state * table.numClasses +
+                                       table.classMap[c]];
+                assert(dfa.graph[state].count(c)
+                           ? next == dfa.graph[state][c]
+                           : next == -1);
+            }
+        }
+        size_t sizeRaw = table.numStates * 256 * sizeof(int32_t);
+        size_t sizeCls = table.numStates * table.numClasses * sizeof(int32_t) +
+                         table.classMap.size();
+        fmt::print("{:>12s}.lexical: {:3d} states, {:3d} classes, "
+                   "table {:6d} -> {:5d} bytes ({:.1f}x)\n",
+                   name, table.numStates, table.numClasses, sizeRaw,
+                   sizeCls, (double) sizeRaw / sizeCls);
+    }
+}
+
+void test5() {
+    fmt::print("test lexical parsing over contiguous buffer \n");
+    fmt::print("------------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    LexicalParser parser(getMinicRegexs());
+    string        src = getMinicSource();
+
+    // same tokens as parsing from istream
+    stringstream  ss(src);
+    vector<Token> tokens = parser.parseAll(ss);
+    size_t        offset = 0;
+    for (const Token &token : tokens) {
+        TokenView view = parser.parseStep(src, offset);
+        assert(view.id == token.id);
+        assert(view.lval(src) == token.lval);
+    }
+    assert(offset == src.size());
+
+    // error message
+    try {
+        offset = 0;
+        string_view bad = "int a = 1; #";
+        while (parser.parseStep(bad, offset).id != END_SYMBOL) {}
+        assert(false);
+    } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+
+    int    numTokens = 0;
+    double t1        = timeit([&]() {
+        parser.clear();
+        stringstream ss(src);
+        numTokens = parser.parseAll(ss).size();
+    });
+    double t2        = timeit([&]() {
+        numTokens      = 0;
+        size_t offset = 0;
+        while (parser.parseStep(src, offset).id != END_SYMBOL) { numTokens++; }
+    });
+    double mb = src.size() / 1e6;
+    fmt::print("input: {} bytes, {} tokens\n", src.size(), numTokens);
+    fmt::print("  LexicalParser (istream):     {:8.2f} MB/s\n", mb / t1);
+    fmt::print("  LexicalParser (string_view): {:8.2f} MB/s\n", mb / t2);
+    krill::log::logger.set_level(level);
+}
+
+void test6() {
+    fmt::print("benchmark self-loop acceleration of lexical parsing \n");
+    fmt::print("--------------------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    // blanks as one token, to have a self-loop on them
+    vector<string> regexs = getMinicRegexs();
+    replace(regexs.begin(), regexs.end(), string("[\\t ]"), string("[\\t ]+"));
+    LexicalParser parser(regexs);
+    string        src = getMinicSource();
+
+    vector<DFA> dfas;
+    for (string regex : regexs) { dfas.push_back(getDFAfromRegex(regex)); }
+    DFAtable         table  = getDFAtable(getDFAintegrated(dfas));
+    vector<DFAaccel> accels = getDFAaccels(table);
+    int numAccel = count_if(accels.begin(), accels.end(),
+                            [](const DFAaccel &a) { return a.numRanges > 0; });
+    fmt::print("{} of {} states acceleratable\n", numAccel, table.numStates);
+
+    // comment-heavy: a long line comment after each line
+    // whitespace-heavy: deep indent and blank lines before each line
+    string       srcComment, srcSpace;
+    stringstream ss(src);
+    for (string line; getline(ss, line);) {
+        srcComment += line + "  // " + string(60, '=') +
+                      " explain what the line above does\n";
+        srcSpace += "\n\n" + string(24, ' ') + "\t\t" + line + "\n";
+    }
+
+    auto parseAll = [&](const string &src) {
+        TokenBuffer tokens;
+        parser.parseAll(src, tokens);
+        return tokens;
+    };
+    for (auto[name, input] : vector<pair<string, const string *>>{
+             {"minic", &src},
+             {"comment-heavy", &srcComment},
+             {"whitespace-heavy", &srcSpace}}) {
+        parser.setAccelerated(false);
+        TokenBuffer tokens1 = parseAll(*input);
+        double      t1      = timeit([&]() { parseAll(*input); });
+        parser.setAccelerated(true);
+        TokenBuffer tokens2 = parseAll(*input);
+        double      t2      = timeit([&]() { parseAll(*input); });
+        assert(tokens1.ids == tokens2.ids);
+        assert(tokens1.offsets == tokens2.offsets);
+        assert(tokens1.lengths == tokens2.lengths);
+
+        double mb = input->size() / 1e6;
+        fmt::print("{:>16s}: {:8d} bytes, {:7d} tokens, "
+                   "{:8.2f} -> {:8.2f} MB/s\n",
+                   name, input->size(), tokens1.size(), mb / t1, mb / t2);
+    }
+    krill::log::logger.set_level(level);
+}
+
+void test7() {
+    fmt::print("test direct-coded lexical parser generation \n");
+    fmt::print("------------------------------------------- \n");
+    vector<string> regexs;
+    stringstream   ss(readTestFile("test/grammar/calculator.lexical"));
+    for (string line; getline(ss, line);) {
+        trim(line);
+        if (line.size() == 0) { continue; }
+        regexs.push_back(line);
+    }
+    stringstream code;
+    krill::codegen::genLexicalParserDirect(regexs, code);
+    fmt::print("{}", code.str());
+}
+
+void test8() {
+    fmt::print("test keywords split off lexical DFA \n");
+    fmt::print("------------------------------------ \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    vector<string> regexs = getMinicRegexs();
+    regexs.push_back("for"); // after identifier, never recognized
+    auto[dfa, keywords] = getDFAwithKeywords(regexs);
+    for (int slot = 0; slot < keywords.ids.size(); slot++) {
+        if (keywords.ids[slot] < 0) { continue; }
+        fmt::print("  slot {:2d}: ‘{}’ <token {}> in <token {}>\n", slot,
+                   keywords.keys[slot], keywords.ids[slot],
+                   keywords.hosts[slot]);
+    }
+
+    vector<DFA> dfas;
+    for (string regex : regexs) { dfas.push_back(getDFAfromRegex(regex)); }
+    LexicalParser parser1(dfas);   // keywords in DFA
+    LexicalParser parser2(regexs); // keywords split off
+    DFAtable      table1 = getDFAtable(getDFAintegrated(dfas));
+    DFAtable      table2 = getDFAtable(dfa);
+
+    string src = getMinicSource() + " for forever whilex _if if0 int";
+    TokenBuffer tokens1, tokens2;
+    parser1.parseAll(src, tokens1);
+    parser2.parseAll(src, tokens2);
+    assert(tokens1.ids == tokens2.ids);
+    assert(tokens1.lengths == tokens2.lengths);
+
+    // same length ^ first byte and last byte, split off still
+    auto [dfa3, keywords3] = getDFAwithKeywords({"c", "abc", "[a-z]+"});
+    assert(keywords3.find(2, "c") == 0 && keywords3.find(2, "abc") == 1);
+
+    double t1 = timeit([&]() {
+        TokenBuffer tokens;
+        parser1.parseAll(src, tokens);
+    });
+    double t2 = timeit([&]() {
+        TokenBuffer tokens;
+        parser2.parseAll(src, tokens);
+    });
+    double mb = src.size() / 1e6;
+    fmt::print("keywords in DFA:    {:3d} states, {:8.2f} MB/s\n",
+               table1.numStates, mb / t1);
+    fmt::print("keywords split off: {:3d} states, {:8.2f} MB/s\n",
+               table2.numStates, mb / t2);
+    krill::log::logger.set_level(level);
+}
+
+void test9() {
+    fmt::print("test parallel lexical parsing \n");
+    fmt::print("----------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    LexicalParser parser(getMinicRegexs());
+    string        src = getMinicSource();
+
+    // same tokens as sequential, chunk boundaries in tokens and comments
+    string small = src.substr(0, 20000);
+    TokenBuffer tokens1;
+    parser.parseAll(small, tokens1);
+    for (int threads : {2, 3, 7, 16, 61, 256}) {
+        TokenBuffer tokens2;
+        parser.parseAllParallel(small, tokens2, threads);
+        assert(tokens1.ids == tokens2.ids);
+        assert(tokens1.offsets == tokens2.offsets);
+        assert(tokens1.lengths == tokens2.lengths);
+    }
+
+    // chunk boundaries inside a long token, and inside a string literal
+    // whose content lexes as code from state 0
+    LexicalParser parser2({"\"[^\"]*\"", "[a-z]+", "[0-9]+", "[ \n]+", ";"});
+    string        literal = "\"";
+    for (int i = 0; i < 200; i++) { literal += "int x ; 42 "; }
+    literal += "\"";
+    for (string text : {string(4000, 'a'), "x " + literal + " ;\n",
+                        literal + literal}) {
+        TokenBuffer tokens3;
+        parser2.parseAll(text, tokens3);
+        for (int threads : {2, 3, 4, 7}) {
+            TokenBuffer tokens4;
+            parser2.parseAllParallel(text, tokens4, threads);
+            assert(tokens3.ids == tokens4.ids);
+            assert(tokens3.offsets == tokens4.offsets);
+            assert(tokens3.lengths == tokens4.lengths);
+        }
+    }
+
+    // same error as sequential
+    string bad = small + "\n@" + small;
+    for (int threads : {1, 4}) {
+        try {
+            TokenBuffer tokens;
+            parser.parseAllParallel(bad, tokens, threads);
+            assert(false);
+        } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+    }
+
+    // scaling
+    while (src.size() < (8 << 20)) { src += src; }
+    TokenBuffer tokens;
+    parser.parseAll(src, tokens);
+    double mb = src.size() / 1e6;
+    fmt::print("input: {} bytes, {} tokens, {} hardware threads\n",
+               src.size(), tokens.size(), std::thread::hardware_concurrency());
+    for (int threads : {1, 2, 4, 8, 16}) {
+        double t = timeit([&]() {
+            TokenBuffer tokens2;
+            parser.parseAllParallel(src, tokens2, threads);
+            assert(tokens2.ids == tokens.ids);
+        });
+        fmt::print("  {:2d} threads: {:8.2f} MB/s\n", threads, mb / t);
+    }
+    krill::log::logger.set_level(level);
+}
+
+void test10() {
+    fmt::print("test push-style lexical parsing \n");
+    fmt::print("------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    LexicalParser parser(getMinicRegexs());
+    string        src = getMinicSource().substr(0, 50000);
+    TokenBuffer   tokens;
+    parser.parseAll(src, tokens);
+
+    // same tokens, whatever the input is split into
+    for (size_t chunkSize : {1, 2, 3, 7, 64, 4096, 1 << 20}) {
+        vector<Token> pushed;
+        parser.tokenFunc_ = [&](int id, string_view lval) {
+            pushed.push_back({id, string(lval)});
+        };
+        for (size_t i = 0; i < src.size(); i += chunkSize) {
+            parser.feed(src.data() + i, std::min(chunkSize, src.size() - i));
+        }
+        parser.finish();
+        assert(pushed.size() == tokens.size());
+        for (int i = 0; i < tokens.size(); i++) {
+            assert(pushed[i].id == tokens.ids[i]);
+            assert(pushed[i].lval ==
+                   src.substr(tokens.offsets[i], tokens.lengths[i]));
+        }
+    }
+    fmt::print("{} tokens, same for all chunk sizes\n", tokens.size());
+
+    // unfinished lexeme is bounded
+    parser.setMaxLexeme(64);
+    parser.tokenFunc_ = defaultTokenFunc;
+    string comment = "/* " + string(100, '-') + " */";
+    try {
+        for (char c : comment) { parser.feed(&c, 1); }
+        assert(false);
+    } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+    parser.clear();
+
+    // unmatched lexeme at the end
+    try {
+        parser.feed("int a; /* x", 11);
+        parser.finish();
+        assert(false);
+    } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+    parser.clear();
+    krill::log::logger.set_level(level);
+}
+
+void test11() {
+    fmt::print("test lazy DFA lexical parsing \n");
+    fmt::print("----------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+
+    // same tokens as eager DFA, also when the cache keeps being flushed
+    vector<string> regexs = getMinicRegexs();
+    string         src    = getMinicSource().substr(0, 200000);
+    TokenBuffer    tokens1, tokens2, tokens3;
+    LexicalParser(regexs).parseAll(src, tokens1);
+    LexicalParser(regexs, true).parseAll(src, tokens2);
+    vector<DFA> dfas;
+    for (int i = 0; i < regexs.size(); i++) {
+        dfas.push_back(getDFAfromRegex(regexs[i]));
+        for (auto &[state, finality] : dfas.back().finality) {
+            if (finality != 0) { finality = i + 1; }
+        }
+    }
+    LexicalParser parser3(LazyDFA(getNFAintegrated(dfas), 8));
+    parser3.parseAll(src, tokens3);
+    for (auto *tokens : {&tokens2, &tokens3}) {
+        assert(tokens->ids == tokens1.ids);
+        assert(tokens->lengths == tokens1.lengths);
+    }
+    fmt::print("minic: same tokens as eager DFA, with 8-state cache too\n");
+
+    // copies own their cache, so they can lex on threads of their own
+    vector<LexicalParser> copies(4, parser3);
+    vector<TokenBuffer>   copyTokens(copies.size());
+    vector<std::thread>   workers;
+    for (int i = 0; i < copies.size(); i++) {
+        workers.emplace_back(
+            [&, i]() { copies[i].parseAll(src, copyTokens[i]); });
+    }
+    for (auto &worker : workers) { worker.join(); }
+    for (auto &tokens : copyTokens) { assert(tokens.ids == tokens1.ids); }
+
+    // thousands of rules: startup time and memory
+    std::mt19937 rng(2022);
+    vector<string> rules;
+    string         text;
+    for (int i = 0; i < 3000; i++) {
+        string word;
+        for (int len = 3 + rng() % 8; len > 0; len--) {
+            word += 'a' + rng() % 26;
+        }
+        rules.push_back(i % 2 ? word : word + "[0-9]+");
+        text += word + (i % 2 ? " " : "42 ");
+    }
+    rules.push_back("[a-z]+");
+    rules.push_back("[0-9]+");
+    rules.push_back("[ \t\n]+");
+    while (text.size() < (1 << 20)) { text += text; }
+
+    for (bool lazy : {true, false}) {
+        LexicalParser parser;
+        double        t0 =
+            timeit([&]() { parser = LexicalParser(rules, lazy); }, 1);
+        TokenBuffer   tokens;
+        double        t1 = timeit([&]() { parser.parseAll(text, tokens); });
+        fmt::print("{} rules, {:5}: startup {:7.3f}s, lexing {:7.2f} MB/s, "
+                   "{} tokens\n",
+                   rules.size(), lazy ? "lazy" : "eager", t0,
+                   text.size() / t1 / 1e6, tokens.size());
+    }
+    krill::log::logger.set_level(level);
+}
+
+void test12() {
+    fmt::print("test on-disk DFA cache \n");
+    fmt::print("---------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info);
+    using krill::cache::DFAcache, krill::cache::setDefaultCache;
+    using krill::cache::getDefaultCache;
+    string dir = (std::filesystem::temp_directory_path() / "krill-test-cache")
+                     .string();
+    std::filesystem::remove_all(dir);
+    setDefaultCache(dir);
+
+    // miss, then hit with the same tokens
+    vector<string> regexs = getMinicRegexs();
+    string         src    = getMinicSource().substr(0, 200000);
+    TokenBuffer    tokens1, tokens2, tokens3;
+    double t1 = timeit([&]() { LexicalParser(regexs).parseAll(src, tokens1); },
+                       1);
+    double t2 = timeit([&]() { LexicalParser(regexs).parseAll(src, tokens2); },
+                       1);
+    setDefaultCache("");
+    LexicalParser(regexs).parseAll(src, tokens3);
+    assert(tokens1.ids == tokens3.ids && tokens2.ids == tokens3.ids);
+    assert(tokens2.lengths == tokens3.lengths);
+    fmt::print("minic: compiled {:.4f}s, loaded {:.4f}s, same tokens\n", t1,
+               t2);
+
+    // thousands of rules, all loaded the second time
+    std::mt19937   rng(2022);
+    vector<string> rules;
+    for (int i = 0; i < 1000; i++) {
+        string word;
+        for (int len = 3 + rng() % 8; len > 0; len--) {
+            word += 'a' + rng() % 26;
+        }
+        rules.push_back(i % 2 ? word : word + "[0-9]+");
+    }
+    rules.push_back("[a-z]+");
+    setDefaultCache(dir);
+    t1 = timeit([&]() { LexicalParser parser(rules); }, 1);
+    t2 = timeit([&]() { LexicalParser parser(rules); }, 1);
+    DFAcache *cache = getDefaultCache();
+    fmt::print("{} rules: compiled {:.4f}s, loaded {:.4f}s, {} hits, {} "
+               "misses\n",
+               rules.size(), t1, t2, cache->numHits(), cache->numMisses());
+    assert(cache->numHits() == 1 && cache->numMisses() == 1);
+
+    // a broken file is a miss, and removed
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        std::filesystem::resize_file(entry.path(), 100);
+    }
+    DFAtable     table;
+    KeywordTable keywords;
+    assert(!cache->load("(a|b)*\0", table, keywords));
+    cache->store("(a|b)*\0", getDFAtable(getDFAfromRegex("(a|b)*")), {});
+    assert(cache->load("(a|b)*\0", table, keywords));
+    assert(!cache->load(regexs[0] + '\0', table, keywords));
+
+    // so is a file of the right sizes but values out of range
+    DFAtable badTable = getDFAtable(getDFAfromRegex("(a|b)*"));
+    badTable.trans[0] = badTable.numStates;
+    cache->store("bad\0", badTable, {});
+    assert(!cache->load("bad\0", table, keywords));
+    badTable = getDFAtable(getDFAfromRegex("(a|b)*"));
+    badTable.classMap['a'] = badTable.numClasses;
+    cache->store("bad\0", badTable, {});
+    assert(!cache->load("bad\0", table, keywords));
+
+    // LRU eviction under the size cap
+    setDefaultCache(dir, 4096);
+    cache = getDefaultCache();
+    cache->clear();
+    for (int i = 0; i < 20; i++) {
+        LexicalParser(vector<string>{fmt::format("a{}b", i), "[a-z]+"});
+        // keep it recently used
+        LexicalParser(vector<string>{"a0b", "[a-z]+"});
+    }
+    uintmax_t totalSize = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+        totalSize += entry.file_size();
+    }
+    assert(totalSize <= 4096 && cache->numEvictions() > 0);
+    assert(cache->load(string("a0b") + '\0' + "[a-z]+" + '\0', table,
+                       keywords));
+    fmt::print("size cap 4096: {} bytes kept, {} evictions\n", totalSize,
+               cache->numEvictions());
+
+    setDefaultCache("");
+    std::filesystem::remove_all(dir);
+    krill::log::logger.set_level(level);
+}
+
+// tokens by all ways of parsing, which must agree
+static vector<Token> parseAllWays(LexicalParser &parser, const string &src) {
+    TokenBuffer tokens;
+    parser.parseAll(src, tokens);
+    vector<Token> result;
+    for (int i = 0; i < tokens.size(); i++) {
+        result.push_back({tokens.ids[i], string(tokens[i].lval(src))});
+    }
+
+    stringstream  ss(src);
+    vector<Token> streamed = parser.parseAll(ss);
+    parser.clear();
+    assert(streamed == result);
+
+    vector<Token> pushed;
+    parser.tokenFunc_ = [&](int id, string_view lval) {
+        pushed.push_back({id, string(lval)});
+    };
+    for (size_t i = 0; i < src.size(); i += 7) {
+        parser.feed(src.data() + i, std::min<size_t>(7, src.size() - i));
+    }
+    parser.finish();
+    parser.tokenFunc_ = defaultTokenFunc;
+    assert(pushed == result);
+    return result;
+}
+
+static int countId(const vector<Token> &tokens, int id) {
+    return std::count_if(tokens.begin(), tokens.end(),
+                         [id](const Token &token) { return token.id == id; });
+}
+
+void test13() {
+    fmt::print("test GlushkovVM fallback of pathological regex \n");
+    fmt::print("---------------------------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info);
+    int budget = maxRuleStates;
+
+    // the n-th last char is 'a': 2^(n+1) DFA states, n+3 positions
+    auto nthLast = [](int n) {
+        string regex = "(a|b)*a";
+        for (int i = 0; i < n; i++) { regex += "(a|b)"; }
+        return regex;
+    };
+    std::mt19937 rng(2022);
+    string       src;
+    for (int i = 0; i < 20000; i++) { src += "aab c"[rng() % 5]; }
+
+    // small ones by DFA and by GlushkovVM (bit-parallel), the same tokens
+    vector<string> rules = {nthLast(8), "[a-c]+", " +"};
+    maxRuleStates        = 0;
+    LexicalParser parser1(rules);
+    maxRuleStates = 64;
+    LexicalParser parser2(rules);
+    LexicalParser parser3(rules, true);
+    assert(krill::regex::GlushkovVM(rules[0]).isBitParallel());
+    vector<Token> tokens = parseAllWays(parser1, src);
+    assert(parseAllWays(parser2, src) == tokens);
+    assert(parseAllWays(parser3, src) == tokens);
+    assert(countId(tokens, 0) > 0);
+    fmt::print("{}: {} tokens, same by DFA and GlushkovVM\n", rules[0],
+               tokens.size());
+
+    // beyond 64 positions, not bit-parallel, and keyword after a VM rule
+    vector<string> words(12);
+    for (string &word : words) {
+        for (int j = 0; j < 9; j++) { word += "abc"[rng() % 3]; }
+    }
+    string alts = words[0];
+    for (int i = 1; i < words.size(); i++) { alts += "|" + words[i]; }
+    rules = {"c", "(" + alts + ")+", "[a-c]+", " +"};
+    assert(!krill::regex::GlushkovVM(rules[1]).isBitParallel());
+    string src2;
+    for (int i = 0; i < 5000; i++) {
+        src2 += (rng() % 4) ? words[rng() % words.size()] : "c";
+        src2 += string(rng() % 2, "ab "[rng() % 3]);
+    }
+    maxRuleStates = 0;
+    LexicalParser parser4(rules);
+    maxRuleStates = 16;
+    LexicalParser parser5(rules);
+    tokens = parseAllWays(parser4, src2);
+    assert(parseAllWays(parser5, src2) == tokens);
+    assert(countId(tokens, 0) > 0 && countId(tokens, 1) > 0);
+    fmt::print("{} positions: {} tokens, same by DFA and GlushkovVM\n",
+               krill::regex::GlushkovVM(rules[1]).numPositions(),
+               tokens.size());
+
+    // 2^21 DFA states, stopped by the budget
+    src.clear();
+    for (int i = 0; i < 2000; i++) {
+        for (int len = 10 + rng() % 30; len > 0; len--) {
+            src += "ab"[rng() % 2];
+        }
+        src += " c "[rng() % 3];
+    }
+    maxRuleStates = budget;
+    rules         = {nthLast(20), "[a-c]+", " +"};
+    LexicalParser parser6;
+    double        t1 = timeit([&]() { parser6 = LexicalParser(rules); }, 1);
+    double t2        = timeit([&]() { tokens = parseAllWays(parser6, src); }, 1);
+    for (const Token &token : tokens) {
+        if (token.id != 0) { continue; }
+        size_t n = token.lval.size();
+        assert(n >= 21 && token.lval[n - 21] == 'a');
+        assert(token.lval.find_first_not_of("ab") == string::npos);
+    }
+    fmt::print("{}: built in {:.4f}s, parsed in {:.4f}s, {} of {} tokens by "
+               "GlushkovVM\n",
+               rules[0], t1, t2, countId(tokens, 0), tokens.size());
+
+    // no GlushkovVM in generated code
+    try {
+        getDFAtableWithKeywords(rules);
+        assert(false);
+    } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+    krill::log::logger.set_level(level);
+}
+
+void test14() {
+    fmt::print("test incremental lexical spec \n");
+    fmt::print("----------------------------- \n");
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info);
+
+    // 100 rules: minic and some more
+    std::mt19937   rng(2022);
+    vector<string> regexs = getMinicRegexs();
+    while (regexs.size() < 100) {
+        string word;
+        for (int len = 3 + rng() % 6; len > 0; len--) { word += 'a' + rng() % 26; }
+        regexs.push_back(regexs.size() % 2 ? "@" + word : word + "#[0-9]+");
+    }
+
+    // the integrated DFA rebuilt from scratch, removed rules accept nothing
+    auto rebuild = [](const vector<string> &rules) {
+        vector<DFA> dfas(rules.size(), DFA({{}, {{0, 0}}}));
+        for (int i = 0; i < rules.size(); i++) {
+            if (rules[i].size() > 0) { dfas[i] = getDFAfromRegex(rules[i]); }
+        }
+        return getDFAintegrated(dfas);
+    };
+    auto isSame = [](const DFA &a, const DFA &b) {
+        return a.graph == b.graph && a.finality == b.finality;
+    };
+
+    LexicalSpec spec(regexs);
+    assert(isSame(getMinimizedDfa(spec.dfa()), rebuild(spec.rules())));
+
+    // edits, each checked against rebuilding
+    vector<string> edits = {"+foreach", "-0", "+@@[a-z]+", "-37", "-101",
+                            "+0x[0-9a-f]+", "-36", "+[a-zA-Z_][a-zA-Z0-9_]*"};
+    double tEdit = 0, tRebuild = 0, tParser = 0;
+    for (const string &edit : edits) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (edit[0] == '+') {
+            spec.addRule(edit.substr(1));
+        } else {
+            spec.removeRule(stoi(edit.substr(1)));
+        }
+        LexicalParser parser1 = spec.parser();
+        auto          t1      = std::chrono::steady_clock::now();
+        DFA           dfa     = rebuild(spec.rules());
+        auto          t2      = std::chrono::steady_clock::now();
+        vector<string> rules;
+        for (const string &rule : spec.rules()) {
+            if (rule.size() > 0) { rules.push_back(rule); }
+        }
+        LexicalParser parser2(rules);
+        auto          t3 = std::chrono::steady_clock::now();
+        assert(isSame(getMinimizedDfa(spec.dfa()), dfa));
+        tEdit += std::chrono::duration<double>(t1 - t0).count();
+        tRebuild += std::chrono::duration<double>(t2 - t1).count();
+        tParser += std::chrono::duration<double>(t3 - t2).count();
+    }
+    fmt::print("{} edits on {} rules, {} states: {:.4f}s per edit, "
+               "{:.4f}s per rebuild (getDFAintegrated), {:.4f}s per "
+               "LexicalParser(regexs)\n",
+               edits.size(), regexs.size(),
+               getMinimizedDfa(spec.dfa()).finality.size(),
+               tEdit / edits.size(), tRebuild / edits.size(),
+               tParser / edits.size());
+
+    // the spec's parser lexes the same as the rebuilt one
+    string        src = getMinicSource().substr(0, 1 << 14);
+    stringstream  ss1(src), ss2(src);
+    vector<Token> tokens1 = spec.parser().parseAll(ss1);
+    vector<Token> tokens2 = LexicalParser(rebuild(spec.rules())).parseAll(ss2);
+    assert(tokens1.size() == tokens2.size());
+    for (int i = 0; i < tokens1.size(); i++) {
+        assert(tokens1[i].id == tokens2[i].id &&
+               tokens1[i].lval == tokens2[i].lval);
+    }
+
+    // removed twice
+    try {
+        spec.removeRule(0);
+        assert(false);
+    } catch (runtime_error &e) { fmt::print("{}\n", e.what()); }
+    krill::log::logger.set_level(level);
+}
+
 int main() {
     krill::log::sink_cerr->set_level(spdlog::level::debug);
-    vector<void (*)()> testFuncs = {test1, test2};
+    vector<void (*)()> testFuncs = {test1, test2, test3, test4, test5, test6,
+                                   test7, test8, test9, test10, test11,
+                                   test12, test13, test14};
     for (int i = 0; i < testFuncs.size(); i++) {
         cout << "#test " << (i + 1) << endl;
         testFuncs[i]();
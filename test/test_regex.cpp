@@ -4,8 +4,13 @@
 #include "krill/defs.h"
 #include "krill/regex.h"
 #include "krill/utils.h"
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <random>
+#include <regex>
 #include <sstream>
+#include <tuple>
 #include <vector>
 using namespace std;
 using namespace krill::type;
@@ -95,8 +100,266 @@ void test1() {
     }
 }
 
+string readTestFile(string path) {
+    for (string prefix : {"", "../", "../../"}) {
+        ifstream file(prefix + path);
+        if (file) {
+            stringstream ss;
+            ss << file.rdbuf();
+            return ss.str();
+        }
+    }
+    throw runtime_error(fmt::format("cannot open test file {}", path));
+}
+
+// random regex over {a, b, c}, for cross-check
+string getRandomRegex(std::mt19937 &rng, int depth) {
+    int k = (depth == 0) ? rng() % 3 : rng() % 9;
+    switch (k) {
+        case 0: return string(1, 'a' + rng() % 3);
+        case 1: return "[a-b]";
+        case 2: return "[^b]";
+        case 3: return "(" + getRandomRegex(rng, depth - 1) + ")*";
+        case 4: return "(" + getRandomRegex(rng, depth - 1) + ")+";
+        case 5: return "(" + getRandomRegex(rng, depth - 1) + ")?";
+        case 6:
+            return "(" + getRandomRegex(rng, depth - 1) + "|" +
+                   getRandomRegex(rng, depth - 1) + ")";
+        default:
+            return "(" + getRandomRegex(rng, depth - 1) +
+                   getRandomRegex(rng, depth - 1) + ")";
+    }
+}
+
+// test followpos construction against Thompson NFA, and benchmark them
+void test2() {
+    vector<string> regexs = {
+        "abc", "a?b+c*d", "b(ac?a|b)+d", "(1|2)(0|1|2)*|0", "[0-2]",
+        "[^a-y]", "[^a-zA-Z0-9]", "\\n", "a*", "(a|b?)*c?", ".*\\.c",
+    };
+    for (string file : {"minic", "calculator", "regex"}) {
+        stringstream ss(
+            readTestFile(fmt::format("test/grammar/{}.lexical", file)));
+        for (string line; getline(ss, line);) {
+            trim(line);
+            if (line.size() > 0) { regexs.push_back(line); }
+        }
+    }
+    regexs.push_back("/\\*([^\\*]|\\*+[^\\*/])*\\*+/");
+    std::mt19937 rng(2022);
+    for (int i = 0; i < 300; i++) { regexs.push_back(getRandomRegex(rng, 4)); }
+
+    for (const string &regex : regexs) {
+        DFA dfa1 = getDFAfromRegex(regex, RegexCompiler::kFollowpos);
+        DFA dfa2 = getDFAfromRegex(regex, RegexCompiler::kThompson);
+        if (dfa1.graph != dfa2.graph || dfa1.finality != dfa2.finality) {
+            cout << fmt::format("mismatched: \"{}\"", regex) << endl;
+            assert(false);
+        }
+    }
+    cout << fmt::format("{} regexs: followpos == thompson\n", regexs.size());
+
+    // compile time
+    string keywords;
+    for (int i = 0; i < 200; i++) {
+        keywords += (i ? "|" : "");
+        for (int len = 2 + rng() % 8; len > 0; len--) {
+            keywords += 'a' + rng() % 26;
+        }
+    }
+    vector<pair<string, vector<string>>> specs = {
+        {"minic.lexical", vector<string>(regexs.begin() + 11,
+                                         regexs.end() - 300)},
+        {"200 keywords", {keywords}},
+    };
+    for (auto &[name, spec] : specs) {
+        double times[2];
+        for (auto compiler :
+             {RegexCompiler::kFollowpos, RegexCompiler::kThompson}) {
+            auto t0 = chrono::steady_clock::now();
+            for (int repeat = 0; repeat < 10; repeat++) {
+                for (const string &regex : spec) {
+                    getDFAfromRegex(regex, compiler);
+                }
+            }
+            times[(int) compiler] =
+                chrono::duration<double>(chrono::steady_clock::now() - t0)
+                    .count() /
+                10;
+        }
+        cout << fmt::format("{:>14}: followpos {:.4f}s, thompson {:.4f}s\n",
+                            name, times[0], times[1]);
+    }
+}
+
+// leftmost-longest non-empty matches, by anchored DFA at every position
+vector<pair<size_t, size_t>> findAllByDFA(DFA &dfa, const string &text) {
+    vector<pair<size_t, size_t>> matches;
+    for (size_t pos = 0; pos < text.size();) {
+        size_t len = 0;
+        for (size_t i = pos, state = 0; i < text.size(); i++) {
+            if (dfa.graph[state].count(text[i]) == 0) { break; }
+            state = dfa.graph[state][text[i]];
+            if (dfa.finality[state] != 0) { len = i + 1 - pos; }
+        }
+        if (len > 0) { matches.push_back({pos, len}); }
+        pos += (len > 0) ? len : 1;
+    }
+    return matches;
+}
+
+// test unanchored search against DFA at every position, and benchmark it
+// against std::regex
+void test3() {
+    std::mt19937 rng(2022);
+    vector<string> regexs = {"abc", "a?b+c*d", "b(ac?a|b)+d", "a*", "c",
+                             "(ab|cd)(a|b)*(ca|da)", "[^a]b?"};
+    for (int i = 0; i < 300; i++) { regexs.push_back(getRandomRegex(rng, 4)); }
+    for (const string &regex : regexs) {
+        DFA      dfa = getDFAfromRegex(regex);
+        Searcher searcher(regex);
+        for (int i = 0; i < 10; i++) {
+            string text;
+            for (int len = rng() % 200; len > 0; len--) {
+                text += "abcd"[rng() % 4];
+            }
+            if (searcher.findAll(text) != findAllByDFA(dfa, text)) {
+                cout << fmt::format("mismatched: \"{}\" in \"{}\"", regex,
+                                    text)
+                     << endl;
+                assert(false);
+            }
+        }
+    }
+    cout << fmt::format("{} regexs: search == DFA at every position\n",
+                        regexs.size());
+
+    // log grepping
+    vector<string> levels = {"INFO", "INFO", "INFO", "DEBUG", "WARN", "ERROR"};
+    string         text;
+    while (text.size() < (1 << 22)) {
+        text += fmt::format(
+            "2022-06-{:02} 12:{:02}:{:02} [{}] worker-{} user{} from "
+            "10.0.{}.{}: {} in {}ms\n",
+            1 + rng() % 30, rng() % 60, rng() % 60, levels[rng() % 6],
+            rng() % 16, rng() % 10000, rng() % 256, rng() % 256,
+            rng() % 50 ? "request served" : "connection timeout",
+            rng() % 1000);
+    }
+    vector<string> patterns = {
+        "ERROR",
+        "connection timeout in [0-9]+ms",
+        "user[0-9]+ from 10\\.0\\.1[0-9]*\\.",
+        "[0-9]+\\.[0-9]+\\.[0-9]+\\.[0-9]+",
+        "\\[(WARN|ERROR)\\] worker",
+    };
+    cout << fmt::format("input: {} bytes of log\n", text.size());
+    for (const string &pattern : patterns) {
+        Searcher                     searcher(pattern);
+        vector<pair<size_t, size_t>> matches1, matches2;
+        auto t0 = chrono::steady_clock::now();
+        matches1 = searcher.findAll(text);
+        auto t1 = chrono::steady_clock::now();
+        std::regex re(pattern);
+        for (auto it = std::cregex_iterator(text.data(),
+                                            text.data() + text.size(), re);
+             it != std::cregex_iterator(); it++) {
+            matches2.push_back({it->position(), it->length()});
+        }
+        auto   t2 = chrono::steady_clock::now();
+        double mb = text.size() / 1e6;
+        assert(matches1 == matches2);
+        cout << fmt::format(
+            "{:>40}: {:6} matches, Searcher {:8.2f} MB/s, "
+            "std::regex {:6.2f} MB/s\n",
+            pattern, matches1.size(),
+            mb / chrono::duration<double>(t1 - t0).count(),
+            mb / chrono::duration<double>(t2 - t1).count());
+    }
+}
+
+// atom{m,n} expanded by hand, like AA(A(A)?)? for A{2,4}
+string expandRepeat(const string &atom, int m, int n) {
+    string regex;
+    for (int i = 0; i < m; i++) { regex += atom; }
+    if (n < 0) { return regex + atom + "*"; }
+    string tail;
+    for (int i = m; i < n; i++) { tail = "(" + atom + tail + ")?"; }
+    return regex + tail;
+}
+
+// test counted repetition {m,n}, against expanded regex and std::regex,
+// and benchmark its compile time
+void test4() {
+    vector<tuple<string, int, int>> repeats = {
+        {"a", 3, 3},        {"a", 2, 4},      {"(ab)", 1, 3},
+        {"(a|b)", 2, -1},   {"[0-9]", 1, 10}, {"(a*)", 2, 3},
+        {"(a?b)", 0, -1},   {"(a|bc?)", 3, 5}, {"(a(ba){2}|b)", 1, 2},
+        {"[^ab]", 0, 2},
+    };
+    std::mt19937 rng(2022);
+    for (auto &[atom, m, n] : repeats) {
+        string regex = atom + (m == n    ? fmt::format("{{{}}}", m)
+                               : n < 0 ? fmt::format("{{{},}}", m)
+                                       : fmt::format("{{{},{}}}", m, n));
+        DFA dfa1 = getDFAfromRegex(regex, RegexCompiler::kFollowpos);
+        DFA dfa2 = getDFAfromRegex(regex, RegexCompiler::kThompson);
+        DFA dfa3 = getDFAfromRegex(expandRepeat(atom, m, n));
+        assert(dfa1.graph == dfa2.graph && dfa1.finality == dfa2.finality);
+        assert(dfa1.graph == dfa3.graph && dfa1.finality == dfa3.finality);
+
+        std::regex re(regex);
+        for (int i = 0; i < 2000; i++) {
+            string text;
+            for (int len = rng() % 12; len > 0; len--) {
+                text += "ab0c9"[rng() % 5];
+            }
+            int state = 0;
+            for (char c : text) {
+                state = dfa1.graph[state].count(c) ? dfa1.graph[state][c] : -1;
+                if (state < 0) { break; }
+            }
+            bool isMatched = state >= 0 && dfa1.finality[state] != 0;
+            assert(isMatched == std::regex_match(text, re));
+        }
+        cout << fmt::format("{:>16}: {} states, same as ‘{}’\n", regex,
+                            dfa1.graph.size(), expandRepeat(atom, m, n));
+    }
+
+    // '{' not of a repetition is a plain char
+    DFA dfa = getDFAfromRegex("a{b}{,2}{");
+    assert(dfa.graph == getDFAfromRegex("a\\{b\\}\\{,2\\}\\{").graph);
+
+    // compile time, linear in n
+    for (int n : {25, 50, 100, 200, 400}) {
+        double times[3];
+        string regexs[3] = {fmt::format("[0-9]{{1,{}}}", n),
+                            fmt::format("[0-9]{{1,{}}}", n),
+                            expandRepeat("[0-9]", 1, n)};
+        for (int k = 0; k < 3; k++) {
+            auto compiler = (k == 1) ? RegexCompiler::kThompson
+                                     : RegexCompiler::kFollowpos;
+            auto t0       = chrono::steady_clock::now();
+            dfa           = getDFAfromRegex(regexs[k], compiler);
+            times[k] =
+                chrono::duration<double>(chrono::steady_clock::now() - t0)
+                    .count();
+        }
+        cout << fmt::format("[0-9]{{1,{}}}: {} states, followpos {:.4f}s, "
+                            "thompson {:.4f}s, expanded {:.4f}s\n",
+                            n, dfa.graph.size(), times[0], times[1],
+                            times[2]);
+    }
+}
+
 int main() {
     cerr << "#test 1\n";
     test1();
+    cerr << "#test 2\n";
+    test2();
+    cerr << "#test 3\n";
+    test3();
+    cerr << "#test 4\n";
+    test4();
     return 0;
 }
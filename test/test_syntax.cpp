@@ -5,6 +5,8 @@
 #include "krill/lexical.h"
 #include "krill/syntax.h"
 #include "krill/utils.h"
+#include <cassert>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <map>
@@ -323,9 +325,98 @@ void test3() {
     }
 }
 
+void test4() {
+    cerr << "parse from columnar token buffer: \n";
+    Grammar             grammar({
+        "Exp_    -> DefExps",
+        "DefExps -> DefExps DefExp",
+        "DefExps -> DefExp",
+        "DefExp  -> varname '=' Exp ';'",
+        "DefExp  -> Exp ';'",
+        "Exp     -> Exp oprt num",
+        "Exp     -> num",
+        "num     -> int",
+        "num     -> float",
+    });
+    map<string, string> nameToRegex = {
+        {"int", "[1-9][0-9]*|0"},
+        {"float", "([1-9][0-9]*|0)?\\.?[0-9]+"},
+        {"varname", "[a-zA-Z][a-zA-Z0-9]*"},
+        {"oprt", "\\+|\\-|\\*|/"},
+        {"'='", "="},
+        {"';'", ";"},
+        {"delim", " +"},
+    };
+    ActionTable actionTable = getLALR1table(grammar);
+
+    LexicalParser lexicalParser(toRegexs(nameToRegex));
+    SyntaxParser  syntaxParser(grammar, actionTable);
+    map<int, int> toSyntaxId =
+        getToSyntaxIdMap(grammar.symbolNames, nameToRegex);
+
+    auto parseByTokens = [&](const string &src) {
+        stringstream  input(src);
+        lexicalParser.clear();
+        vector<Token> tokens = lexicalParser.parseAll(input);
+        vector<Token> syntaxTokens;
+        for (auto elem : tokens) {
+            if (toSyntaxId.count(elem.id)) {
+                elem.id = toSyntaxId.at(elem.id);
+                syntaxTokens.push_back(elem);
+            }
+        }
+        syntaxParser.clear();
+        syntaxParser.parseAll(syntaxTokens);
+        return syntaxParser.getAPT();
+    };
+    auto parseByBuffer = [&](const string &src) {
+        TokenBuffer tokens;
+        lexicalParser.parseAll(src, tokens);
+        // map to syntax id and drop delimiters, in place
+        size_t n = 0;
+        for (size_t i = 0; i < tokens.size(); i++) {
+            auto it = toSyntaxId.find(tokens.ids[i]);
+            if (it == toSyntaxId.end()) { continue; }
+            tokens.ids[n]     = it->second;
+            tokens.offsets[n] = tokens.offsets[i];
+            tokens.lengths[n] = tokens.lengths[i];
+            n++;
+        }
+        tokens.ids.resize(n), tokens.offsets.resize(n), tokens.lengths.resize(n);
+        syntaxParser.clear();
+        syntaxParser.parseAll(tokens, src);
+        return syntaxParser.getAPT();
+    };
+
+    string line = "a =1 + 21; b=2*0/1; 1 /1-1; ";
+    string apt1 = getAPTstr(parseByTokens(line), grammar);
+    string apt2 = getAPTstr(parseByBuffer(line), grammar);
+    assert(apt1 == apt2);
+    cerr << apt2;
+
+    // benchmark (not too long, DefExps grows a deep left-recursive tree)
+    auto level = krill::log::logger.level();
+    krill::log::logger.set_level(spdlog::level::info); // no per-token log
+    string src;
+    while (src.size() < (1 << 16)) { src += line; }
+    auto timeit = [](auto func) {
+        auto st = chrono::steady_clock::now();
+        func();
+        auto ed = chrono::steady_clock::now();
+        return chrono::duration<double>(ed - st).count();
+    };
+    double t1 = timeit([&]() { parseByTokens(src); });
+    double t2 = timeit([&]() { parseByBuffer(src); });
+    double mb = src.size() / 1e6;
+    cerr << fmt::format("input: {} bytes\n", src.size());
+    cerr << fmt::format("  vector<Token>: {:8.2f} MB/s\n", mb / t1);
+    cerr << fmt::format("  TokenBuffer:   {:8.2f} MB/s\n", mb / t2);
+    krill::log::logger.set_level(level);
+}
+
 int main() {
     krill::log::sink_cerr->set_level(spdlog::level::debug);
-    vector<void (*)()> testFuncs = {test1, test2, test3};
+    vector<void (*)()> testFuncs = {test1, test2, test3, test4};
     for (int i = 0; i < testFuncs.size(); i++) {
         cerr << "#test " << (i + 1) << endl;
         testFuncs[i]();